@@ -0,0 +1,255 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <new>
+
+#include "wasm.hh"
+
+// Count heap allocations made while measuring.
+std::atomic<bool> counting(false);
+std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size) {
+  if (counting) ++allocations;
+  auto p = std::malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  if (counting) ++allocations;
+  return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& nt) noexcept {
+  return operator new(size, nt);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+
+const int N = 1000000;
+
+// Run f N times, print ns per iteration and allocations per iteration.
+template<class F>
+auto measure(const char* name, F f) -> size_t {
+  for (int i = 0; i < N / 100; ++i) f();  // warm up
+  allocations = 0;
+  counting = true;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) f();
+  auto end = std::chrono::steady_clock::now();
+  counting = false;
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+  std::cout << "> " << name << ": "
+    << static_cast<double>(ns.count()) / N << " ns, "
+    << static_cast<double>(allocations) / N << " allocations" << std::endl;
+  return allocations;
+}
+
+
+// Host functions incrementing their argument.
+auto host_callback(
+  void* env, const wasm::vec<wasm::Val>& args, wasm::vec<wasm::Val>& results
+) -> wasm::own<wasm::Trap> {
+  results[0] = wasm::Val::i32(args[0].i32() + 1);
+  return nullptr;
+}
+
+auto host_callback_raw(
+  void* env, const wasm::Val args[], wasm::Val results[]
+) -> wasm::own<wasm::Trap> {
+  results[0] = wasm::Val::i32(args[0].i32() + 1);
+  return nullptr;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("callbench.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Create external host functions.
+  std::cout << "Creating callbacks..." << std::endl;
+  auto host_type = wasm::FuncType::make(
+    wasm::ownvec<wasm::ValType>::make(wasm::ValType::make(wasm::ValKind::I32)),
+    wasm::ownvec<wasm::ValType>::make(wasm::ValType::make(wasm::ValKind::I32))
+  );
+  auto host_func = wasm::Func::make(
+    store, host_type.get(), host_callback, nullptr);
+  auto host_func_raw = wasm::Func::make(
+    store, host_type.get(), host_callback_raw, nullptr);
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make(host_func.get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  auto imports_raw = wasm::vec<wasm::Extern*>::make(host_func_raw.get());
+  auto instance_raw = wasm::Instance::make(store, module.get(), imports_raw);
+  if (!instance || !instance_raw) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Extract export.
+  std::cout << "Extracting exports..." << std::endl;
+  auto exports = instance->exports();
+  auto exports_raw = instance_raw->exports();
+  if (exports.size() < 6 || exports_raw.size() < 6 || !exports_raw[2]->func()) {
+    std::cout << "> Error accessing exports!" << std::endl;
+    exit(1);
+  }
+  for (size_t i = 0; i < exports.size(); ++i) {
+    if (exports[i]->kind() != wasm::ExternKind::FUNC || !exports[i]->func()) {
+      std::cout << "> Error accessing exports!" << std::endl;
+      exit(1);
+    }
+  }
+  auto nop_func = exports[0]->func();
+  auto add_func = exports[1]->func();
+  auto call_host_func = exports[2]->func();
+  auto call_host_raw_func = exports_raw[2]->func();
+  auto add_i64_func = exports[3]->func();
+  auto add_f64_func = exports[4]->func();
+  auto add_mixed_func = exports[5]->func();
+
+  // Measure.
+  std::cout << "Measuring signature queries..." << std::endl;
+  size_t arity = 0;
+  auto allocs = measure("param_arity", [&] { arity += add_func->param_arity(); });
+  allocs += measure("result_arity", [&] { arity += add_func->result_arity(); });
+  if (allocs != 0 || arity != (N + N / 100) * 3) {
+    std::cout << "> Error, signature queries allocate!" << std::endl;
+    exit(1);
+  }
+
+  std::cout << "Measuring calls..." << std::endl;
+  auto no_args = wasm::vec<wasm::Val>::make();
+  auto no_results = wasm::vec<wasm::Val>::make();
+  measure("call nop", [&] {
+    if (nop_func->call(no_args, no_results)) exit(1);
+  });
+
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(3), wasm::Val::i32(4));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  measure("call add", [&] {
+    if (add_func->call(args, results)) exit(1);
+  });
+  if (results[0].i32() != 7) {
+    std::cout << "> Error, wrong result!" << std::endl;
+    exit(1);
+  }
+
+  results[0] = wasm::Val::i32(0);
+  measure("call_unchecked nop", [&] {
+    if (nop_func->call_unchecked(nullptr, nullptr)) exit(1);
+  });
+  measure("call_unchecked add", [&] {
+    if (add_func->call_unchecked(args.get(), results.get())) exit(1);
+  });
+  if (results[0].i32() != 7) {
+    std::cout << "> Error, wrong result!" << std::endl;
+    exit(1);
+  }
+
+  // Signatures with values of a single kind are converted in one loop, mixed
+  // ones with a converter call per value.
+  std::cout << "Measuring calls by signature..." << std::endl;
+  auto args_i64 = wasm::vec<wasm::Val>::make(
+    wasm::Val::i64(3), wasm::Val::i64(4));
+  measure("call_unchecked add i64", [&] {
+    if (add_i64_func->call_unchecked(args_i64.get(), results.get())) exit(1);
+  });
+  if (results[0].i64() != 7) {
+    std::cout << "> Error, wrong result!" << std::endl;
+    exit(1);
+  }
+  auto args_f64 = wasm::vec<wasm::Val>::make(
+    wasm::Val::f64(1.5), wasm::Val::f64(2));
+  measure("call_unchecked add f64", [&] {
+    if (add_f64_func->call_unchecked(args_f64.get(), results.get())) exit(1);
+  });
+  if (results[0].f64() != 3.5) {
+    std::cout << "> Error, wrong result!" << std::endl;
+    exit(1);
+  }
+  auto args_mixed = wasm::vec<wasm::Val>::make(
+    wasm::Val::i32(1), wasm::Val::i64(2), wasm::Val::f64(0.5));
+  measure("call_unchecked add mixed", [&] {
+    if (add_mixed_func->call_unchecked(args_mixed.get(), results.get())) {
+      exit(1);
+    }
+  });
+  if (results[0].f64() != 3.5) {
+    std::cout << "> Error, wrong result!" << std::endl;
+    exit(1);
+  }
+
+  std::cout << "Measuring callbacks..." << std::endl;
+  auto arg = wasm::Val::i32(41);
+  measure("callback", [&] {
+    if (call_host_func->call_unchecked(&arg, results.get())) exit(1);
+  });
+  if (results[0].i32() != 42) {
+    std::cout << "> Error, wrong result!" << std::endl;
+    exit(1);
+  }
+  results[0] = wasm::Val::i32(0);
+  measure("callback raw", [&] {
+    if (call_host_raw_func->call_unchecked(&arg, results.get())) exit(1);
+  });
+  if (results[0].i32() != 42) {
+    std::cout << "> Error, wrong result!" << std::endl;
+    exit(1);
+  }
+
+  auto& counters = store->counters();
+  std::cout << "Call stubs: " << counters.call_stub_hits << " hits, "
+    << counters.call_stub_misses << " misses" << std::endl;
+  std::cout << "Func wrappers: " << counters.func_wrapper_hits << " hits, "
+    << counters.func_wrapper_misses << " misses" << std::endl;
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
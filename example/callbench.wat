@@ -0,0 +1,22 @@
+(module
+  (func $host (import "" "host") (param i32) (result i32))
+  (func (export "nop"))
+  (func (export "add") (param i32 i32) (result i32)
+    (i32.add (local.get 0) (local.get 1))
+  )
+  (func (export "call_host") (param i32) (result i32)
+    (call $host (local.get 0))
+  )
+  (func (export "add_i64") (param i64 i64) (result i64)
+    (i64.add (local.get 0) (local.get 1))
+  )
+  (func (export "add_f64") (param f64 f64) (result f64)
+    (f64.add (local.get 0) (local.get 1))
+  )
+  (func (export "add_mixed") (param i32 i64 f64) (result f64)
+    (f64.add
+      (f64.add (f64.convert_i32_s (local.get 0)) (f64.convert_i64_s (local.get 1)))
+      (local.get 2)
+    )
+  )
+)
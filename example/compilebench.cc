@@ -0,0 +1,178 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <chrono>
+#include <algorithm>
+
+#include "wasm.hh"
+
+const int COMPILES = 100;
+const int CALLS = 20;
+const int32_t ITERATIONS = 10000000;
+const size_t CHUNK_SIZE = 16;
+
+
+// Count asynchronously compiled modules.
+void compiled(void* env, wasm::own<wasm::Module>&& module) {
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+  ++*static_cast<int*>(env);
+}
+
+// Parse the compilation mode, which applies to the whole process.
+auto compile_mode(int argc, const char* argv[]) -> wasm::Config::CompileMode {
+  if (argc < 2 || std::strcmp(argv[1], "tiered") == 0) {
+    return wasm::Config::CompileMode::TIERED;
+  } else if (std::strcmp(argv[1], "baseline") == 0) {
+    return wasm::Config::CompileMode::BASELINE;
+  } else if (std::strcmp(argv[1], "optimized") == 0) {
+    return wasm::Config::CompileMode::OPTIMIZED;
+  } else if (std::strcmp(argv[1], "lazy") == 0) {
+    return wasm::Config::CompileMode::LAZY;
+  }
+  std::cout << "> Usage: compilebench [tiered|baseline|optimized|lazy]"
+    << std::endl;
+  exit(1);
+}
+
+// Report how many functions have code, which under lazy compilation are
+// only those called so far.
+void print_compiled(const wasm::Module* module) {
+  auto tiers = module->func_tiers();
+  size_t compiled = 0;
+  for (size_t i = 0; i < tiers.size(); ++i) {
+    if (tiers[i] != wasm::Module::FuncTier::NONE) ++compiled;
+  }
+  std::cout << "> compiled functions: " << compiled << " of "
+    << tiers.size() << std::endl;
+}
+
+
+void run(wasm::Config::CompileMode mode) {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto config = wasm::Config::make();
+  config->set_compile_mode(mode);
+  auto engine = wasm::Engine::make(std::move(config));
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("compilebench.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module " << COMPILES << " times..." << std::endl;
+  wasm::own<wasm::Module> module;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < COMPILES; ++i) {
+    module = wasm::Module::make(store, binary);
+    if (!module) {
+      std::cout << "> Error compiling module!" << std::endl;
+      exit(1);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  std::cout << "> compile: " << static_cast<double>(us.count()) / COMPILES
+    << " us" << std::endl;
+
+  std::cout << "Compiling module " << COMPILES << " times in the background..."
+    << std::endl;
+  int count = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < COMPILES; ++i) {
+    wasm::Module::compile_async(store, binary, compiled, &count);
+  }
+  while (store->pump(true)) {}
+  end = std::chrono::steady_clock::now();
+  us = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  if (count != COMPILES) {
+    std::cout << "> Error, missing modules!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> compile_async: " << static_cast<double>(us.count()) / COMPILES
+    << " us" << std::endl;
+
+  std::cout << "Compiling module " << COMPILES << " times from "
+    << CHUNK_SIZE << "-byte chunks..." << std::endl;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < COMPILES; ++i) {
+    auto stream = wasm::ModuleStream::make(store);
+    if (!stream) {
+      std::cout << "> Error creating module stream!" << std::endl;
+      exit(1);
+    }
+    for (size_t offset = 0; offset < binary.size(); offset += CHUNK_SIZE) {
+      auto size = std::min(CHUNK_SIZE, binary.size() - offset);
+      if (!stream->push(binary.get() + offset, size)) break;
+    }
+    module = stream->finish();
+    if (!module) {
+      std::cout << "> Error compiling module!" << std::endl;
+      exit(1);
+    }
+  }
+  end = std::chrono::steady_clock::now();
+  us = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  std::cout << "> stream: " << static_cast<double>(us.count()) / COMPILES
+    << " us" << std::endl;
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+  auto export_ = instance->export_by_index(0);
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  print_compiled(module.get());
+
+  // Measure, reporting the first call separately from the steady state.
+  std::cout << "Calling export " << CALLS << " times..." << std::endl;
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(ITERATIONS));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  for (int i = 0; i < CALLS; ++i) {
+    start = std::chrono::steady_clock::now();
+    if (export_->func()->call(args, results)) {
+      std::cout << "> Error calling export!" << std::endl;
+      exit(1);
+    }
+    end = std::chrono::steady_clock::now();
+    us = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    if (i == 0 || i == CALLS - 1) {
+      std::cout << "> " << (i == 0 ? "first" : "last") << " call: "
+        << us.count() << " us" << std::endl;
+    }
+  }
+  print_compiled(module.get());
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run(compile_mode(argc, argv));
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,19 @@
+(module
+  (func (export "run") (param $n i32) (result i64)
+    (local $i i32) (local $acc i64)
+    (block $done
+      (loop $loop
+        (br_if $done (i32.ge_u (local.get $i) (local.get $n)))
+        (local.set $acc
+          (i64.add
+            (i64.mul (local.get $acc) (i64.const 6364136223846793005))
+            (i64.extend_i32_u (local.get $i))
+          )
+        )
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $loop)
+      )
+    )
+    (local.get $acc)
+  )
+)
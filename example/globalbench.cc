@@ -0,0 +1,111 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+
+#include "wasm.hh"
+
+const int N = 10000;
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("globalbench.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Measure.
+  std::cout << "Creating " << N << " globals..." << std::endl;
+  auto type = wasm::GlobalType::make(
+    wasm::ValType::make(wasm::ValKind::I32), wasm::Mutability::VAR);
+  auto globals = wasm::ownvec<wasm::Global>::make_uninitialized(N);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) {
+    globals[i] = wasm::Global::make(store, type.get(), wasm::Val::i32(i));
+    if (!globals[i]) {
+      std::cout << "> Error creating global!" << std::endl;
+      exit(1);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  std::cout << "> " << N * 1000000.0 / us.count() << " globals/s" << std::endl;
+
+  auto& counters = store->counters();
+  std::cout << "Global wrappers: " << counters.global_wrapper_hits << " hits, "
+    << counters.global_wrapper_misses << " misses" << std::endl;
+
+  std::cout << "Reading globals..." << std::endl;
+  int64_t sum = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) sum += globals[i]->get().i32();
+  end = std::chrono::steady_clock::now();
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+  std::cout << "> get: " << ns.count() / N << " ns" << std::endl;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) sum -= globals[i]->get_i32();
+  end = std::chrono::steady_clock::now();
+  ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+  std::cout << "> get_i32: " << ns.count() / N << " ns" << std::endl;
+  if (sum != 0) {
+    std::cout << "> Error, wrong global values!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make(globals[N - 1].get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Check.
+  std::cout << "Reading global..." << std::endl;
+  auto exports = instance->exports();
+  if (exports.size() == 0 || !exports[0]->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto args = wasm::vec<wasm::Val>::make();
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (exports[0]->func()->call(args, results) || results[0].i32() != N - 1) {
+    std::cout << "> Error reading global!" << std::endl;
+    exit(1);
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
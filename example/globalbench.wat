@@ -0,0 +1,4 @@
+(module
+  (global $g (import "" "g") (mut i32))
+  (func (export "get") (result i32) (global.get $g))
+)
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+
+#include "wasm.hh"
+
+const int N = 300;
+
+// A host function adding one to its argument, or doing nothing.
+auto callback(
+  void* env, const wasm::vec<wasm::Val>& args, wasm::vec<wasm::Val>& results
+) -> wasm::own<wasm::Trap> {
+  if (args.size() == 1 && results.size() == 1) {
+    results[0] = wasm::Val::i32(args[0].i32() + 1);
+  } else if (results.size() == 1) {
+    results[0] = wasm::Val::f32(0);
+  }
+  return nullptr;
+}
+
+// Print time taken by f.
+template<class F>
+void measure(const char* name, F f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  std::cout << "> " << name << ": " << us.count() << " us" << std::endl;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("hostbench.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Create host function types, matching the module's imports.
+  auto import_types = module->imports();
+  if (import_types.size() != 3) {
+    std::cout << "> Error accessing imports!" << std::endl;
+    exit(1);
+  }
+  auto specs = wasm::vec<wasm::Func::Spec>::make_uninitialized(N);
+  for (int i = 0; i < N; ++i) {
+    auto type = import_types[i % 3]->type()->func();
+    specs[i] = wasm::Func::Spec{type, callback, nullptr, nullptr};
+  }
+
+  // Measure.
+  std::cout << "Creating " << N << " host functions..." << std::endl;
+  auto funcs = wasm::ownvec<wasm::Func>::make_uninitialized(N);
+  measure("one by one", [&] {
+    for (int i = 0; i < N; ++i) {
+      funcs[i] = wasm::Func::make(store, specs[i].type, callback, nullptr);
+      if (!funcs[i]) exit(1);
+    }
+  });
+  measure("batch", [&] {
+    funcs = wasm::Func::make_batch(store, specs);
+    if (!funcs) exit(1);
+  });
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make(
+    funcs[0].get(), funcs[1].get(), funcs[2].get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Call.
+  std::cout << "Calling export..." << std::endl;
+  auto exports = instance->exports();
+  if (exports.size() == 0 || !exports[0]->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(1));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (exports[0]->func()->call(args, results) || results[0].i32() != 2) {
+    std::cout << "> Error calling export!" << std::endl;
+    exit(1);
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,8 @@
+(module
+  (func $f0 (import "" "f0") (param i32) (result i32))
+  (func $f1 (import "" "f1") (param i64 f64))
+  (func $f2 (import "" "f2") (result f32))
+  (func (export "run") (param i32) (result i32)
+    (call $f0 (local.get 0))
+  )
+)
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// Check that exactly the given functions have been compiled.
+void check_compiled(const wasm_module_t* module, bool used, bool unused) {
+  own wasm_func_tier_vec_t tiers;
+  wasm_module_func_tiers(module, &tiers);
+  if (tiers.size != 2) {
+    printf("> Error, wrong number of functions!\n");
+    exit(1);
+  }
+  bool compiled[] = {used, unused};
+  for (size_t i = 0; i < tiers.size; ++i) {
+    wasm_func_tier_t tier = tiers.data[i];
+    printf("> function %zu: %s\n", i,
+      tier == WASM_FUNC_TIER_NONE ? "not compiled" :
+      tier == WASM_FUNC_TIER_BASELINE ? "baseline" : "optimized");
+    if ((tier != WASM_FUNC_TIER_NONE) != compiled[i]) {
+      printf("> Error, unexpected compilation state!\n");
+      exit(1);
+    }
+  }
+  wasm_func_tier_vec_delete(&tiers);
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_config_t* config = wasm_config_new();
+  wasm_config_set_compile_mode(config, WASM_COMPILE_LAZY);
+  wasm_engine_t* engine = wasm_engine_new_with_config(config);
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("lazy.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  printf("Checking compilation before calls...\n");
+  check_compiled(module, false, false);
+
+  // Call.
+  printf("Calling export...\n");
+  wasm_name_t name;
+  wasm_name_new_from_string(&name, "used");
+  own wasm_extern_t* used = wasm_instance_export_by_name(instance, &name);
+  wasm_name_delete(&name);
+  const wasm_func_t* used_func = used ? wasm_extern_as_func(used) : NULL;
+  if (!used_func) {
+    printf("> Error accessing export!\n");
+    return 1;
+  }
+  wasm_val_vec_t args = WASM_EMPTY_VEC;
+  wasm_val_t vs[1];
+  wasm_val_vec_t results = WASM_ARRAY_VEC(vs);
+  if (wasm_func_call(used_func, &args, &results) || vs[0].of.i32 != 1) {
+    printf("> Error calling function!\n");
+    return 1;
+  }
+
+  printf("Checking compilation after calls...\n");
+  check_compiled(module, true, false);
+
+  wasm_extern_delete(used);
+  wasm_instance_delete(instance);
+  wasm_module_delete(module);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+// Check that exactly the given functions have been compiled.
+void check_compiled(const wasm::Module* module, bool used, bool unused) {
+  auto tiers = module->func_tiers();
+  if (tiers.size() != 2) {
+    std::cout << "> Error, wrong number of functions!" << std::endl;
+    exit(1);
+  }
+  bool compiled[] = {used, unused};
+  for (size_t i = 0; i < tiers.size(); ++i) {
+    auto tier = tiers[i];
+    std::cout << "> function " << i << ": "
+      << (tier == wasm::Module::FuncTier::NONE ? "not compiled" :
+          tier == wasm::Module::FuncTier::BASELINE ? "baseline" : "optimized")
+      << std::endl;
+    if ((tier != wasm::Module::FuncTier::NONE) != compiled[i]) {
+      std::cout << "> Error, unexpected compilation state!" << std::endl;
+      exit(1);
+    }
+  }
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto config = wasm::Config::make();
+  config->set_compile_mode(wasm::Config::CompileMode::LAZY);
+  auto engine = wasm::Engine::make(std::move(config));
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("lazy.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  std::cout << "Checking compilation before calls..." << std::endl;
+  check_compiled(module.get(), false, false);
+
+  // Call.
+  std::cout << "Calling export..." << std::endl;
+  auto used = instance->export_by_name(wasm::Name::make(std::string("used")));
+  if (!used || !used->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto args = wasm::vec<wasm::Val>::make();
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (used->func()->call(args, results) || results[0].i32() != 1) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+
+  std::cout << "Checking compilation after calls..." << std::endl;
+  check_compiled(module.get(), true, false);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,4 @@
+(module
+  (func (export "used") (result i32) (i32.const 1))
+  (func (export "unused") (result i32) (i32.const 2))
+)
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+#define POOL_SIZE 2
+#define ROUNDS 5
+
+
+int32_t call_next(const wasm_instance_t* instance) {
+  wasm_name_t name;
+  wasm_name_new_from_string(&name, "next");
+  own wasm_extern_t* next = wasm_instance_export_by_name(instance, &name);
+  wasm_name_delete(&name);
+  const wasm_func_t* func = next ? wasm_extern_as_func(next) : NULL;
+  if (!func) {
+    printf("> Error accessing export!\n");
+    exit(1);
+  }
+  wasm_val_vec_t args = WASM_EMPTY_VEC;
+  wasm_val_t vs[1];
+  wasm_val_vec_t results = WASM_ARRAY_VEC(vs);
+  if (wasm_func_call(func, &args, &results)) {
+    printf("> Error calling function!\n");
+    exit(1);
+  }
+  wasm_extern_delete(next);
+  return vs[0].of.i32;
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("pool.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Create pool.
+  printf("Creating instance pool...\n");
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_pool_t* pool =
+    wasm_instance_pool_new(store, module, &imports, POOL_SIZE, NULL);
+  if (!pool) {
+    printf("> Error creating instance pool!\n");
+    return 1;
+  }
+
+  wasm_module_delete(module);
+
+  // Use pooled instances. Their counter is not exported, so it cannot be
+  // reset, and each acquired instance must start from zero.
+  printf("Acquiring instances %d times...\n", ROUNDS);
+  for (int i = 0; i < ROUNDS; ++i) {
+    own wasm_instance_t* instance = wasm_instance_pool_acquire(pool);
+    if (!instance) {
+      printf("> Error acquiring instance!\n");
+      return 1;
+    }
+    int32_t first = call_next(instance);
+    int32_t second = call_next(instance);
+    printf("> %"PRId32" %"PRId32"\n", first, second);
+    if (first != 1 || second != 2) {
+      printf("> Error, state leaked between uses!\n");
+      return 1;
+    }
+    wasm_instance_pool_release(pool, instance);
+  }
+
+  wasm_instance_pool_metrics_t metrics;
+  wasm_instance_pool_metrics(pool, &metrics);
+  printf("Pool: %zu hits, %zu misses, %zu resets, %zu discards\n",
+    metrics.hits, metrics.misses, metrics.resets, metrics.discards);
+  if (metrics.resets != 0) {
+    printf("> Error, instance with hidden state reused!\n");
+    return 1;
+  }
+
+  wasm_instance_pool_delete(pool);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
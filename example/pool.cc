@@ -0,0 +1,104 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+const size_t POOL_SIZE = 2;
+const int ROUNDS = 5;
+
+
+auto call_next(const wasm::Instance* instance) -> int32_t {
+  auto next = instance->export_by_name(wasm::Name::make(std::string("next")));
+  if (!next || !next->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto args = wasm::vec<wasm::Val>::make();
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (next->func()->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+  return results[0].i32();
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("pool.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Create pool.
+  std::cout << "Creating instance pool..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto pool = wasm::InstancePool::make(store, module.get(), imports, POOL_SIZE);
+  if (!pool) {
+    std::cout << "> Error creating instance pool!" << std::endl;
+    exit(1);
+  }
+
+  // Use pooled instances. Their counter is not exported, so it cannot be
+  // reset, and each acquired instance must start from zero.
+  std::cout << "Acquiring instances " << ROUNDS << " times..." << std::endl;
+  for (int i = 0; i < ROUNDS; ++i) {
+    auto instance = pool->acquire();
+    if (!instance) {
+      std::cout << "> Error acquiring instance!" << std::endl;
+      exit(1);
+    }
+    auto first = call_next(instance.get());
+    auto second = call_next(instance.get());
+    std::cout << "> " << first << " " << second << std::endl;
+    if (first != 1 || second != 2) {
+      std::cout << "> Error, state leaked between uses!" << std::endl;
+      exit(1);
+    }
+    pool->release(std::move(instance));
+  }
+
+  auto& metrics = pool->metrics();
+  std::cout << "Pool: " << metrics.hits << " hits, " << metrics.misses
+    << " misses, " << metrics.resets << " resets, " << metrics.discards
+    << " discards" << std::endl;
+  if (metrics.resets != 0) {
+    std::cout << "> Error, instance with hidden state reused!" << std::endl;
+    exit(1);
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,7 @@
+(module
+  (global $requests (mut i32) (i32.const 0))
+  (func (export "next") (result i32)
+    (global.set $requests (i32.add (global.get $requests) (i32.const 1)))
+    (global.get $requests)
+  )
+)
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+
+#include "wasm.hh"
+
+const int N = 1000;
+const size_t POOL_SIZE = 4;
+
+
+// Run the instance's request handler, which returns 1 on a pristine instance
+// whose table still refers to its own functions.
+auto handle_request(const wasm::Instance* instance) -> int32_t {
+  auto run = instance->export_by_name(wasm::Name::make(std::string("run")));
+  if (!run || !run->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto args = wasm::vec<wasm::Val>::make();
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (run->func()->call(args, results)) {
+    std::cout << "> Error calling export!" << std::endl;
+    exit(1);
+  }
+  return results[0].i32();
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("poolbench.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Create pool.
+  std::cout << "Creating instance pool..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto pool = wasm::InstancePool::make(store, module.get(), imports, POOL_SIZE);
+  if (!pool) {
+    std::cout << "> Error creating instance pool!" << std::endl;
+    exit(1);
+  }
+
+  // Measure.
+  std::cout << "Serving " << N << " requests with fresh instances..." << std::endl;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) {
+    auto instance = wasm::Instance::make(store, module.get(), imports);
+    if (!instance || handle_request(instance.get()) != 1) {
+      std::cout << "> Error, instance not pristine!" << std::endl;
+      exit(1);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  std::cout << "> " << static_cast<double>(us.count()) / N << " us/request" << std::endl;
+
+  std::cout << "Serving " << N << " requests with pooled instances..." << std::endl;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) {
+    auto instance = pool->acquire();
+    if (!instance || handle_request(instance.get()) != 1) {
+      std::cout << "> Error, instance not pristine!" << std::endl;
+      exit(1);
+    }
+    pool->release(std::move(instance));
+  }
+  end = std::chrono::steady_clock::now();
+  us = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  std::cout << "> " << static_cast<double>(us.count()) / N << " us/request" << std::endl;
+
+  auto& metrics = pool->metrics();
+  std::cout << "Pool: " << metrics.hits << " hits, " << metrics.misses
+    << " misses, " << metrics.resets << " resets, " << metrics.discards
+    << " discards" << std::endl;
+  if (metrics.resets > 0) {
+    std::cout << "> reset: " << metrics.reset_ns / metrics.resets
+      << " ns, instantiate: "
+      << metrics.instantiate_ns / (metrics.misses + POOL_SIZE) << " ns"
+      << std::endl;
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
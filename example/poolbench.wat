@@ -0,0 +1,16 @@
+(module
+  (type $load (func (result i32)))
+  (memory (export "memory") 1)
+  (global $counter (export "counter") (mut i32) (i32.const 0))
+  (table (export "table") 1 funcref)
+  (elem (i32.const 0) $load)
+  (func $load (type $load)
+    (i32.load (i32.const 0))
+  )
+  (func (export "run") (result i32)
+    (global.set $counter (i32.add (global.get $counter) (i32.const 1)))
+    (i32.store (i32.const 0)
+      (i32.add (i32.load (i32.const 0)) (global.get $counter)))
+    (call_indirect (type $load) (i32.const 0))
+  )
+)
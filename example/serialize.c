@@ -17,6 +17,28 @@ own wasm_trap_t* hello_callback(
 }
 
 
+// The layout of serialized module headers and their payload checksum, as in
+// src/wasm-v8.cc, to build artifacts that only fail after the header check.
+static const size_t header_size = 48;
+static const size_t header_size_offset = 32;
+static const size_t header_checksum_offset = 40;
+
+uint64_t checksum(const byte_t* data, size_t size) {
+  uint64_t hash = 0xcbf29ce484222325;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * 0x100000001b3;
+    hash ^= hash >> 29;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ (uint8_t)data[i]) * 0x100000001b3;
+  }
+  return hash;
+}
+
+
 int main(int argc, const char* argv[]) {
   // Initialize.
   printf("Initializing...\n");
@@ -66,6 +88,53 @@ int main(int argc, const char* argv[]) {
     return 1;
   }
 
+  // Truncated artifacts are rejected, whether in memory or in a file.
+  printf("Deserializing truncated module...\n");
+  for (size_t size = 0; size < serialized.size; size += 7) {
+    wasm_byte_vec_t truncated;
+    wasm_byte_vec_new(&truncated, size, serialized.data);
+    const char* path = "serialize-truncated.bin";
+    FILE* out = fopen(path, "wb");
+    if (!out || (size > 0 && fwrite(truncated.data, size, 1, out) != 1)) {
+      printf("> Error writing truncated module!\n");
+      return 1;
+    }
+    fclose(out);
+    own wasm_module_t* from_memory = wasm_module_deserialize(store, &truncated);
+    own wasm_module_t* from_file = wasm_module_deserialize_mapped(store, path);
+    remove(path);
+    wasm_byte_vec_delete(&truncated);
+    if (from_memory || from_file) {
+      printf("> Error, truncated module accepted!\n");
+      return 1;
+    }
+  }
+
+  // Payloads whose binary length prefix is overlong or exceeds the payload
+  // are rejected, even with a valid header.
+  printf("Deserializing module with bad length...\n");
+  const uint8_t prefixes[][12] = {
+    {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0xff, 0xff, 0xff, 0xff, 0x0f, 0, 0, 0, 0, 0, 0, 0},
+  };
+  for (size_t i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); ++i) {
+    uint64_t size = sizeof(prefixes[i]);
+    wasm_byte_vec_t corrupt;
+    wasm_byte_vec_new_uninitialized(&corrupt, header_size + size);
+    byte_t* payload = corrupt.data + header_size;
+    memcpy(corrupt.data, serialized.data, header_size);
+    memcpy(payload, prefixes[i], size);
+    uint64_t sum = checksum(payload, size);
+    memcpy(corrupt.data + header_size_offset, &size, sizeof(size));
+    memcpy(corrupt.data + header_checksum_offset, &sum, sizeof(sum));
+    own wasm_module_t* module = wasm_module_deserialize(store, &corrupt);
+    wasm_byte_vec_delete(&corrupt);
+    if (module) {
+      printf("> Error, bad length accepted!\n");
+      return 1;
+    }
+  }
+
   wasm_byte_vec_delete(&serialized);
 
   // Create external print functions.
@@ -3,6 +3,8 @@
 #include <cstdlib>
 #include <string>
 #include <cinttypes>
+#include <cstdio>
+#include <cstring>
 
 #include "wasm.hh"
 
@@ -17,6 +19,28 @@ auto hello_callback(
 }
 
 
+// The layout of serialized module headers and their payload checksum, as in
+// src/wasm-v8.cc, to build artifacts that only fail after the header check.
+const size_t header_size = 48;
+const size_t header_size_offset = 32;
+const size_t header_checksum_offset = 40;
+
+auto checksum(const byte_t* data, size_t size) -> uint64_t {
+  uint64_t hash = 0xcbf29ce484222325;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * 0x100000001b3;
+    hash ^= hash >> 29;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * 0x100000001b3;
+  }
+  return hash;
+}
+
+
 void run() {
   // Initialize.
   std::cout << "Initializing..." << std::endl;
@@ -58,6 +82,50 @@ void run() {
     exit(1);
   }
 
+  // Truncated artifacts are rejected, whether in memory or in a file.
+  std::cout << "Deserializing truncated module..." << std::endl;
+  for (size_t size = 0; size < serialized.size(); size += 7) {
+    auto truncated = wasm::vec<byte_t>::make_uninitialized(size);
+    if (size > 0) std::memcpy(truncated.get(), serialized.get(), size);
+    auto path = "serialize-truncated.bin";
+    std::ofstream out(path, std::ios::binary);
+    out.write(truncated.get(), size);
+    out.close();
+    if (out.fail()) {
+      std::cout << "> Error writing truncated module!" << std::endl;
+      exit(1);
+    }
+    auto from_memory = wasm::Module::deserialize(store, truncated);
+    auto from_file = wasm::Module::deserialize_mapped(store, path);
+    std::remove(path);
+    if (from_memory || from_file) {
+      std::cout << "> Error, truncated module accepted!" << std::endl;
+      exit(1);
+    }
+  }
+
+  // Payloads whose binary length prefix is overlong or exceeds the payload
+  // are rejected, even with a valid header.
+  std::cout << "Deserializing module with bad length..." << std::endl;
+  const uint8_t prefixes[][12] = {
+    {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0xff, 0xff, 0xff, 0xff, 0x0f, 0, 0, 0, 0, 0, 0, 0},
+  };
+  for (auto& prefix : prefixes) {
+    uint64_t size = sizeof(prefix);
+    auto corrupt = wasm::vec<byte_t>::make_uninitialized(header_size + size);
+    auto payload = corrupt.get() + header_size;
+    std::memcpy(corrupt.get(), serialized.get(), header_size);
+    std::memcpy(payload, prefix, size);
+    auto sum = checksum(payload, size);
+    std::memcpy(corrupt.get() + header_size_offset, &size, sizeof(size));
+    std::memcpy(corrupt.get() + header_checksum_offset, &sum, sizeof(sum));
+    if (wasm::Module::deserialize(store, corrupt)) {
+      std::cout << "> Error, bad length accepted!" << std::endl;
+      exit(1);
+    }
+  }
+
   // Create external print functions.
   std::cout << "Creating callback..." << std::endl;
   auto hello_type = wasm::FuncType::make(
@@ -128,6 +128,29 @@ WASM_API_EXTERN own wasm_config_t* wasm_config_new();
 
 // Embedders may provide custom functions for manipulating configs.
 
+// Heap limits for each store, in bytes. Zero keeps V8's default.
+WASM_API_EXTERN void wasm_config_set_max_old_space_size(wasm_config_t*, size_t);
+WASM_API_EXTERN void wasm_config_set_max_semi_space_size(wasm_config_t*, size_t);
+WASM_API_EXTERN void wasm_config_set_code_range_size(wasm_config_t*, size_t);
+
+// Heap sizing and GC hints, shared by all stores of an engine.
+WASM_API_EXTERN void wasm_config_set_initial_old_space_size(wasm_config_t*, size_t);
+WASM_API_EXTERN void wasm_config_set_optimize_for_memory(wasm_config_t*, bool);
+
+typedef uint8_t wasm_compile_mode_t;
+enum wasm_compile_mode_enum {
+  WASM_COMPILE_TIERED,
+  WASM_COMPILE_BASELINE,
+  WASM_COMPILE_OPTIMIZED,
+  WASM_COMPILE_LAZY,
+};
+
+WASM_API_EXTERN void wasm_config_set_compile_mode(wasm_config_t*, wasm_compile_mode_t);
+WASM_API_EXTERN void wasm_config_set_compile_workers(wasm_config_t*, size_t);
+
+WASM_API_EXTERN void wasm_config_set_cache_directory(wasm_config_t*, const char* path);
+WASM_API_EXTERN void wasm_config_set_cache_size_limit(wasm_config_t*, size_t);
+
 
 // Engine
 
@@ -143,6 +166,31 @@ WASM_DECLARE_OWN(store)
 
 WASM_API_EXTERN own wasm_store_t* wasm_store_new(wasm_engine_t*);
 
+typedef struct wasm_store_counters_t {
+  size_t call_stub_hits;
+  size_t call_stub_misses;
+  size_t func_wrapper_hits;
+  size_t func_wrapper_misses;
+  size_t global_wrapper_hits;
+  size_t global_wrapper_misses;
+  size_t handles_live;
+  size_t handles_free;
+  size_t handles_peak;
+  size_t handle_chunks_allocated;
+  size_t handle_chunks_released;
+  size_t refs_borrowed;
+  size_t cache_hits;
+  size_t cache_misses;
+  size_t cache_evictions;
+  size_t cache_load_ns;
+  size_t cache_compile_ns;
+} wasm_store_counters_t;
+
+WASM_API_EXTERN void wasm_store_counters(
+  const wasm_store_t*, wasm_store_counters_t* out);
+
+WASM_API_EXTERN bool wasm_store_pump(wasm_store_t*, bool wait);
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Type Representations
@@ -402,27 +450,74 @@ WASM_API_EXTERN own wasm_module_t* wasm_module_new(
 
 WASM_API_EXTERN bool wasm_module_validate(wasm_store_t*, const wasm_byte_vec_t* binary);
 
+typedef void (*wasm_module_compile_callback_t)(void* env, own wasm_module_t*);
+
+WASM_API_EXTERN void wasm_module_compile_async(
+  wasm_store_t*, const wasm_byte_vec_t* binary,
+  wasm_module_compile_callback_t, void* env);
+
 WASM_API_EXTERN void wasm_module_imports(const wasm_module_t*, own wasm_importtype_vec_t* out);
 WASM_API_EXTERN void wasm_module_exports(const wasm_module_t*, own wasm_exporttype_vec_t* out);
 
+typedef uint8_t wasm_func_tier_t;
+enum wasm_func_tier_enum {
+  WASM_FUNC_TIER_NONE,
+  WASM_FUNC_TIER_BASELINE,
+  WASM_FUNC_TIER_OPTIMIZED,
+};
+
+WASM_DECLARE_VEC(func_tier, )
+
+WASM_API_EXTERN void wasm_module_func_tiers(const wasm_module_t*, own wasm_func_tier_vec_t* out);
+
 WASM_API_EXTERN void wasm_module_serialize(const wasm_module_t*, own wasm_byte_vec_t* out);
 WASM_API_EXTERN own wasm_module_t* wasm_module_deserialize(wasm_store_t*, const wasm_byte_vec_t*);
+WASM_API_EXTERN own wasm_module_t* wasm_module_deserialize_mapped(wasm_store_t*, const char* path);
+
+
+// Streaming Compilation
+
+WASM_DECLARE_OWN(module_stream)
+
+WASM_API_EXTERN own wasm_module_stream_t* wasm_module_stream_new(wasm_store_t*);
+WASM_API_EXTERN bool wasm_module_stream_push(
+  wasm_module_stream_t*, const wasm_byte_t* data, size_t size);
+WASM_API_EXTERN own wasm_module_t* wasm_module_stream_finish(wasm_module_stream_t*);
 
 
 // Function Instances
 
 WASM_DECLARE_REF(func)
 
+// Reference arguments are borrowed, valid only until the callback returns.
 typedef own wasm_trap_t* (*wasm_func_callback_t)(
   const wasm_val_vec_t* args, own wasm_val_vec_t* results);
 typedef own wasm_trap_t* (*wasm_func_callback_with_env_t)(
   void* env, const wasm_val_vec_t* args, wasm_val_vec_t* results);
+typedef own wasm_trap_t* (*wasm_func_callback_raw_t)(
+  void* env, const wasm_val_t args[], wasm_val_t results[]);
 
 WASM_API_EXTERN own wasm_func_t* wasm_func_new(
   wasm_store_t*, const wasm_functype_t*, wasm_func_callback_t);
 WASM_API_EXTERN own wasm_func_t* wasm_func_new_with_env(
   wasm_store_t*, const wasm_functype_t* type, wasm_func_callback_with_env_t,
   void* env, void (*finalizer)(void*));
+WASM_API_EXTERN own wasm_func_t* wasm_func_new_raw(
+  wasm_store_t*, const wasm_functype_t* type, wasm_func_callback_raw_t,
+  void* env, void (*finalizer)(void*));
+
+typedef struct wasm_func_spec_t {
+  const wasm_functype_t* type;
+  wasm_func_callback_with_env_t callback;
+  void* env;
+  void (*finalizer)(void*);
+} wasm_func_spec_t;
+
+// Creates many host functions at once, sharing one compiled wrapper.
+// On failure, all entries of `out` are set to null.
+WASM_API_EXTERN void wasm_func_new_batch(
+  wasm_store_t*, size_t, const wasm_func_spec_t specs[],
+  own wasm_func_t* out[]);
 
 WASM_API_EXTERN own wasm_functype_t* wasm_func_type(const wasm_func_t*);
 WASM_API_EXTERN size_t wasm_func_param_arity(const wasm_func_t*);
@@ -430,6 +525,8 @@ WASM_API_EXTERN size_t wasm_func_result_arity(const wasm_func_t*);
 
 WASM_API_EXTERN own wasm_trap_t* wasm_func_call(
   const wasm_func_t*, const wasm_val_vec_t* args, wasm_val_vec_t* results);
+WASM_API_EXTERN own wasm_trap_t* wasm_func_call_unchecked(
+  const wasm_func_t*, const wasm_val_t args[], wasm_val_t results[]);
 
 
 // Global Instances
@@ -444,6 +541,16 @@ WASM_API_EXTERN own wasm_globaltype_t* wasm_global_type(const wasm_global_t*);
 WASM_API_EXTERN void wasm_global_get(const wasm_global_t*, own wasm_val_t* out);
 WASM_API_EXTERN void wasm_global_set(wasm_global_t*, const wasm_val_t*);
 
+// Accessors not matching the content type return 0 or ignore the value.
+WASM_API_EXTERN int32_t wasm_global_get_i32(const wasm_global_t*);
+WASM_API_EXTERN int64_t wasm_global_get_i64(const wasm_global_t*);
+WASM_API_EXTERN float32_t wasm_global_get_f32(const wasm_global_t*);
+WASM_API_EXTERN float64_t wasm_global_get_f64(const wasm_global_t*);
+WASM_API_EXTERN void wasm_global_set_i32(wasm_global_t*, int32_t);
+WASM_API_EXTERN void wasm_global_set_i64(wasm_global_t*, int64_t);
+WASM_API_EXTERN void wasm_global_set_f32(wasm_global_t*, float32_t);
+WASM_API_EXTERN void wasm_global_set_f64(wasm_global_t*, float64_t);
+
 
 // Table Instances
 
@@ -481,6 +588,12 @@ WASM_API_EXTERN size_t wasm_memory_data_size(const wasm_memory_t*);
 WASM_API_EXTERN wasm_memory_pages_t wasm_memory_size(const wasm_memory_t*);
 WASM_API_EXTERN bool wasm_memory_grow(wasm_memory_t*, wasm_memory_pages_t delta);
 
+WASM_DECLARE_OWN(memory_snapshot)
+
+WASM_API_EXTERN own wasm_memory_snapshot_t* wasm_memory_snapshot(const wasm_memory_t*);
+WASM_API_EXTERN bool wasm_memory_restore(wasm_memory_t*, const wasm_memory_snapshot_t*);
+WASM_API_EXTERN wasm_memory_pages_t wasm_memory_snapshot_size(const wasm_memory_snapshot_t*);
+
 
 // Externals
 
@@ -522,6 +635,37 @@ WASM_API_EXTERN own wasm_instance_t* wasm_instance_new(
 
 WASM_API_EXTERN void wasm_instance_exports(const wasm_instance_t*, own wasm_extern_vec_t* out);
 
+WASM_API_EXTERN own wasm_extern_t* wasm_instance_export_by_name(
+  const wasm_instance_t*, const wasm_name_t*);
+WASM_API_EXTERN own wasm_extern_t* wasm_instance_export_by_index(
+  const wasm_instance_t*, size_t);
+
+
+// Instance Pools
+
+WASM_DECLARE_OWN(instance_pool)
+
+WASM_API_EXTERN own wasm_instance_pool_t* wasm_instance_pool_new(
+  wasm_store_t*, const wasm_module_t*, const wasm_extern_vec_t* imports,
+  size_t size, own wasm_trap_t**);
+
+WASM_API_EXTERN own wasm_instance_t* wasm_instance_pool_acquire(
+  wasm_instance_pool_t*);
+WASM_API_EXTERN void wasm_instance_pool_release(
+  wasm_instance_pool_t*, own wasm_instance_t*);
+
+typedef struct wasm_instance_pool_metrics_t {
+  size_t hits;
+  size_t misses;
+  size_t resets;
+  size_t discards;
+  uint64_t instantiate_ns;
+  uint64_t reset_ns;
+} wasm_instance_pool_metrics_t;
+
+WASM_API_EXTERN void wasm_instance_pool_metrics(
+  const wasm_instance_pool_t*, wasm_instance_pool_metrics_t* out);
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Convenience
@@ -201,6 +201,33 @@ public:
   static auto make() -> own<Config>;
 
   // Implementations may provide custom methods for manipulating Configs.
+
+  // Heap limits for each store, in bytes. Zero keeps V8's default.
+  void set_max_old_space_size(size_t);
+  void set_max_semi_space_size(size_t);
+  void set_code_range_size(size_t);
+
+  // Heap sizing and GC hints, shared by all stores of an engine.
+  void set_initial_old_space_size(size_t);
+  void set_optimize_for_memory(bool);
+
+  // Compilation strategy, shared by all stores of an engine. TIERED compiles
+  // with the baseline compiler and optimizes in the background, BASELINE and
+  // OPTIMIZED use only one compiler, and LAZY compiles each function on its
+  // first call.
+  enum class CompileMode : uint8_t { TIERED, BASELINE, OPTIMIZED, LAZY };
+  void set_compile_mode(CompileMode);
+
+  // Number of background compilation threads, shared by all stores of an
+  // engine. Zero picks a default based on the number of cores.
+  void set_compile_workers(size_t);
+
+  // Directory for caching compiled modules across processes, used by
+  // Module::make. Entries are evicted, least recently used first, to keep
+  // the directory within the size limit in bytes, unless that is zero.
+  // Ignored on hosts without POSIX file APIs.
+  void set_cache_directory(const char* path);
+  void set_cache_size_limit(size_t);
 };
 
 
@@ -225,6 +252,35 @@ public:
   void operator delete(void*);
 
   static auto make(Engine*) -> own<Store>;
+
+  // Runtime statistics, accumulated over the lifetime of the store. The
+  // live and free handle counts are current values.
+  struct Counters {
+    size_t call_stub_hits;
+    size_t call_stub_misses;
+    size_t func_wrapper_hits;
+    size_t func_wrapper_misses;
+    size_t global_wrapper_hits;
+    size_t global_wrapper_misses;
+    size_t handles_live;
+    size_t handles_free;
+    size_t handles_peak;
+    size_t handle_chunks_allocated;
+    size_t handle_chunks_released;
+    size_t refs_borrowed;
+    size_t cache_hits;
+    size_t cache_misses;
+    size_t cache_evictions;
+    size_t cache_load_ns;
+    size_t cache_compile_ns;
+  };
+
+  auto counters() const -> const Counters&;
+
+  // Runs pending completions of asynchronous operations on the calling
+  // thread. If wait is set and any are pending, blocks until there is work.
+  // Returns whether any remain pending.
+  auto pump(bool wait = false) -> bool;
 };
 
 
@@ -595,14 +651,53 @@ public:
   static auto make(Store*, const vec<byte_t>& binary) -> own<Module>;
   auto copy() const -> own<Module>;
 
+  // Compiles on background threads. The callback receives the module, or
+  // null on failure, from a later Store::pump. It is called immediately if
+  // compilation cannot be started, and with null for compilations still
+  // pending when the store is destroyed.
+  using compile_callback = void (*)(void* env, own<Module>&&);
+  static void compile_async(
+    Store*, const vec<byte_t>& binary, compile_callback, void* env);
+
   auto imports() const -> ownvec<ImportType>;
   auto exports() const -> ownvec<ExportType>;
 
+  // The tier of the code each function currently runs, indexed like the
+  // module's functions, including imports. Imports, and functions not called
+  // yet under Config::CompileMode::LAZY, have none.
+  enum class FuncTier : uint8_t { NONE, BASELINE, OPTIMIZED };
+  auto func_tiers() const -> vec<FuncTier>;
+
   auto share() const -> own<Shared<Module>>;
   static auto obtain(Store*, const Shared<Module>*) -> own<Module>;
 
+  // Serialized modules are only compatible with the same engine build,
+  // flags, and CPU features; deserializing others fails.
   auto serialize() const -> vec<byte_t>;
   static auto deserialize(Store*, const vec<byte_t>&) -> own<Module>;
+  // Deserializes the contents of a file, mapped into memory instead of read
+  // where the host supports it.
+  static auto deserialize_mapped(Store*, const char* path) -> own<Module>;
+};
+
+
+// Streaming Compilation
+
+// Compiles a module from chunks of its binary as they arrive, decoding and
+// compiling function bodies on background threads before the last chunk.
+class WASM_API_EXTERN ModuleStream {
+public:
+  ModuleStream() = delete;
+  ~ModuleStream();
+  void operator delete(void*);
+
+  static auto make(Store*) -> own<ModuleStream>;
+
+  // Returns false once compilation has failed.
+  auto push(const byte_t* data, size_t size) -> bool;
+  // Waits for compilation to complete, pumping the store. Returns null if it
+  // failed. No more chunks may be pushed.
+  auto finish() -> own<Module>;
 };
 
 
@@ -654,12 +749,29 @@ public:
   Func() = delete;
   ~Func();
 
+  // Reference arguments passed to callbacks are borrowed: they are only
+  // valid until the callback returns, and must be copied to be retained.
   using callback = auto (*)(const vec<Val>&, vec<Val>&) -> own<Trap>;
   using callback_with_env = auto (*)(void*, const vec<Val>&, vec<Val>&) -> own<Trap>;
+  // Receives arrays of param_arity() arguments and result_arity() results,
+  // which are only valid for the duration of the call.
+  using callback_raw = auto (*)(void*, const Val[], Val[]) -> own<Trap>;
 
   static auto make(Store*, const FuncType*, callback) -> own<Func>;
   static auto make(Store*, const FuncType*, callback_with_env,
     void*, void (*finalizer)(void*) = nullptr) -> own<Func>;
+  static auto make(Store*, const FuncType*, callback_raw,
+    void*, void (*finalizer)(void*) = nullptr) -> own<Func>;
+
+  struct Spec {
+    const FuncType* type;
+    callback_with_env callback;
+    void* env;
+    void (*finalizer)(void*);
+  };
+
+  // Creates many host functions at once, sharing one compiled wrapper.
+  static auto make_batch(Store*, const vec<Spec>&) -> ownvec<Func>;
   auto copy() const -> own<Func>;
 
   auto type() const -> own<FuncType>;
@@ -667,6 +779,10 @@ public:
   auto result_arity() const -> size_t;
 
   auto call(const vec<Val>&, vec<Val>&) const -> own<Trap>;
+
+  // Fast path taking plain arrays of param_arity() arguments and
+  // result_arity() results. Argument kinds are not checked.
+  auto call_unchecked(const Val args[], Val results[]) const -> own<Trap>;
 };
 
 
@@ -683,6 +799,17 @@ public:
   auto type() const -> own<GlobalType>;
   auto get() const -> Val;
   void set(const Val&);
+
+  // Typed accessors for the global's content type. Others return zero or
+  // leave the global unchanged.
+  auto get_i32() const -> int32_t;
+  auto get_i64() const -> int64_t;
+  auto get_f32() const -> float32_t;
+  auto get_f64() const -> float64_t;
+  void set_i32(int32_t);
+  void set_i64(int64_t);
+  void set_f32(float32_t);
+  void set_f64(float64_t);
 };
 
 
@@ -709,6 +836,8 @@ public:
 
 // Memory Instances
 
+class MemorySnapshot;
+
 class WASM_API_EXTERN Memory : public Extern {
 public:
   Memory() = delete;
@@ -726,6 +855,22 @@ public:
   auto data_size() const -> size_t;
   auto size() const -> pages_t;
   auto grow(pages_t delta) -> bool;
+
+  // Records a copy of the current contents, for restoring them later.
+  // Restoring fails if the memory's size differs from the snapshot's. It
+  // compares the whole memory with the copy, so it takes time proportional
+  // to the memory's size, but only writes the parts that changed.
+  auto snapshot() const -> own<MemorySnapshot>;
+  auto restore(const MemorySnapshot*) -> bool;
+};
+
+class WASM_API_EXTERN MemorySnapshot {
+public:
+  MemorySnapshot() = delete;
+  ~MemorySnapshot();
+  void operator delete(void*);
+
+  auto size() const -> Memory::pages_t;
 };
 
 
@@ -742,6 +887,45 @@ public:
   auto copy() const -> own<Instance>;
 
   auto exports() const -> ownvec<Extern>;
+
+  // Single exports, or null if there is no such export.
+  auto export_by_name(const Name&) const -> own<Extern>;
+  auto export_by_index(size_t) const -> own<Extern>;
+};
+
+
+// Instance Pools
+
+// Keeps pre-instantiated instances of a module, and restores released
+// instances to their initial state for reuse. Memories, tables and mutable
+// globals that are imported are shared, not restored. If the module does not
+// export all others, released instances are replaced with fresh ones.
+class WASM_API_EXTERN InstancePool {
+public:
+  InstancePool() = delete;
+  ~InstancePool();
+  void operator delete(void*);
+
+  static auto make(
+    Store*, const Module*, const vec<Extern*>&, size_t size,
+    own<Trap>* = nullptr
+  ) -> own<InstancePool>;
+
+  // Takes a pooled instance, or instantiates a new one if none is left.
+  auto acquire() -> own<Instance>;
+  // Hands an acquired instance back to the pool, which always takes it.
+  void release(own<Instance>);
+
+  struct Metrics {
+    size_t hits;  // acquisitions served from the pool
+    size_t misses;  // acquisitions that instantiated
+    size_t resets;  // instances restored on release
+    size_t discards;  // instances dropped on release
+    uint64_t instantiate_ns;  // total time spent instantiating
+    uint64_t reset_ns;  // total time spent restoring
+  };
+
+  auto metrics() const -> const Metrics&;
 };
 
 
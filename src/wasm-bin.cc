@@ -1,6 +1,8 @@
 #include "wasm-bin.hh"
 
 #include <cstring>
+#include <string>
+#include <vector>
 
 namespace wasm {
 namespace bin {
@@ -129,6 +131,69 @@ auto wrapper(const FuncType* type) -> vec<byte_t> {
   return binary;
 }
 
+// Imports and re-exports n functions, each named by its decimal index.
+auto wrapper(size_t n, const FuncType* const types[]) -> vec<byte_t> {
+  size_t type_size = 5;
+  size_t import_size = 5;
+  size_t export_size = 5;
+  for (size_t i = 0; i < n; ++i) {
+    auto name_size = std::to_string(i).size();
+    type_size += 11 + types[i]->params().size() + types[i]->results().size();
+    import_size += 8 + name_size;
+    export_size += 7 + name_size;
+  }
+  auto size = 8 + 18 + type_size + import_size + export_size;
+  auto binary = vec<byte_t>::make_uninitialized(size);
+  auto ptr = binary.get();
+
+  encode_header(ptr);
+
+  *ptr++ = 0x01;  // type section
+  encode_size32(ptr, type_size);  // size
+  encode_size32(ptr, n);  // length
+  for (size_t i = 0; i < n; ++i) {
+    auto& params = types[i]->params();
+    auto& results = types[i]->results();
+    *ptr++ = 0x60;  // function
+    encode_size32(ptr, params.size());
+    for (size_t j = 0; j < params.size(); ++j) {
+      encode_valtype(ptr, params[j].get());
+    }
+    encode_size32(ptr, results.size());
+    for (size_t j = 0; j < results.size(); ++j) {
+      encode_valtype(ptr, results[j].get());
+    }
+  }
+
+  *ptr++ = 0x02;  // import section
+  encode_size32(ptr, import_size);  // size
+  encode_size32(ptr, n);  // length
+  for (size_t i = 0; i < n; ++i) {
+    auto name = std::to_string(i);
+    *ptr++ = 0;  // module length
+    *ptr++ = name.size();  // name length
+    std::memcpy(ptr, name.data(), name.size());
+    ptr += name.size();
+    *ptr++ = 0x00;  // func
+    encode_size32(ptr, i);  // type index
+  }
+
+  *ptr++ = 0x07;  // export section
+  encode_size32(ptr, export_size);  // size
+  encode_size32(ptr, n);  // length
+  for (size_t i = 0; i < n; ++i) {
+    auto name = std::to_string(i);
+    *ptr++ = name.size();  // name length
+    std::memcpy(ptr, name.data(), name.size());
+    ptr += name.size();
+    *ptr++ = 0x00;  // func
+    encode_size32(ptr, i);  // func index
+  }
+
+  assert(ptr - binary.get() == size);
+  return binary;
+}
+
 auto wrapper(const GlobalType* type) -> vec<byte_t> {
   auto size = 25 + zero_size(type->content());
   auto binary = vec<byte_t>::make_uninitialized(size);
@@ -185,6 +250,18 @@ auto u64(const byte_t*& pos) -> uint64_t {
   return n;
 }
 
+// Fails if the number does not end before `end` or takes too many bytes.
+auto u64(const byte_t*& pos, const byte_t* end, uint64_t* n) -> bool {
+  *n = 0;
+  for (uint64_t shift = 0; shift < 64; shift += 7) {
+    if (pos == end) return false;
+    auto b = static_cast<uint8_t>(*pos++);
+    *n |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if ((b & 0x80) == 0) return true;
+  }
+  return false;
+}
+
 void u32_skip(const byte_t*& pos) {
   bin::u32(pos);
 }
@@ -552,6 +629,43 @@ auto exports(const vec<byte_t>& binary,
   return exports;
 }
 
+// Whether the module defines a memory, table, or mutable global that it does
+// not export, and whose state is therefore out of the embedder's reach.
+auto hidden_state(const vec<byte_t>& binary) -> bool {
+  auto types = bin::types(binary);
+  auto imports = bin::imports(binary, types);
+  auto globals = bin::globals(binary, imports);
+  auto tables = bin::tables(binary, imports);
+  auto memories = bin::memories(binary, imports);
+  std::vector<bool> exported_globals(globals.size());
+  std::vector<bool> exported_tables(tables.size());
+  std::vector<bool> exported_memories(memories.size());
+  auto pos = bin::section(binary, SEC_EXPORT);
+  size_t size = pos != nullptr ? bin::u32(pos) : 0;
+  for (uint32_t i = 0; i < size; ++i) {
+    bin::name_skip(pos);
+    auto tag = *pos++;
+    auto index = bin::u32(pos);
+    switch (tag) {
+      case 0x01: exported_tables[index] = true; break;
+      case 0x02: exported_memories[index] = true; break;
+      case 0x03: exported_globals[index] = true; break;
+    }
+  }
+  for (auto i = count(imports, ExternKind::GLOBAL); i < globals.size(); ++i) {
+    if (globals[i]->mutability() == Mutability::VAR && !exported_globals[i]) {
+      return true;
+    }
+  }
+  for (auto i = count(imports, ExternKind::TABLE); i < tables.size(); ++i) {
+    if (!exported_tables[i]) return true;
+  }
+  for (auto i = count(imports, ExternKind::MEMORY); i < memories.size(); ++i) {
+    if (!exported_memories[i]) return true;
+  }
+  return false;
+}
+
 auto imports(const vec<byte_t>& binary) -> ownvec<ImportType> {
   return bin::imports(binary, bin::types(binary));
 }
@@ -12,12 +12,15 @@ void encode_u32(char*& ptr, uint32_t n);
 void encode_u64(char*& ptr, uint64_t n);
 auto u32(const byte_t*& pos) -> uint32_t;
 auto u64(const byte_t*& pos) -> uint64_t;
+auto u64(const byte_t*& pos, const byte_t* end, uint64_t* n) -> bool;
 
 auto wrapper(const FuncType*) -> vec<byte_t>;
+auto wrapper(size_t n, const FuncType* const[]) -> vec<byte_t>;
 auto wrapper(const GlobalType*) -> vec<byte_t>;
 
 auto imports(const vec<byte_t>& binary) -> ownvec<ImportType>;
 auto exports(const vec<byte_t>& binary) -> ownvec<ExportType>;
+auto hidden_state(const vec<byte_t>& binary) -> bool;
 
 }  // namespace bin
 }  // namespace wasm
@@ -211,6 +211,44 @@ wasm_config_t* wasm_config_new() {
   return release_config(Config::make());
 }
 
+void wasm_config_set_max_old_space_size(wasm_config_t* config, size_t size) {
+  config->set_max_old_space_size(size);
+}
+
+void wasm_config_set_max_semi_space_size(wasm_config_t* config, size_t size) {
+  config->set_max_semi_space_size(size);
+}
+
+void wasm_config_set_code_range_size(wasm_config_t* config, size_t size) {
+  config->set_code_range_size(size);
+}
+
+void wasm_config_set_initial_old_space_size(wasm_config_t* config, size_t size) {
+  config->set_initial_old_space_size(size);
+}
+
+void wasm_config_set_optimize_for_memory(wasm_config_t* config, bool enable) {
+  config->set_optimize_for_memory(enable);
+}
+
+void wasm_config_set_compile_mode(
+  wasm_config_t* config, wasm_compile_mode_t mode
+) {
+  config->set_compile_mode(static_cast<Config::CompileMode>(mode));
+}
+
+void wasm_config_set_compile_workers(wasm_config_t* config, size_t workers) {
+  config->set_compile_workers(workers);
+}
+
+void wasm_config_set_cache_directory(wasm_config_t* config, const char* path) {
+  config->set_cache_directory(path);
+}
+
+void wasm_config_set_cache_size_limit(wasm_config_t* config, size_t size) {
+  config->set_cache_size_limit(size);
+}
+
 
 // Engine
 
@@ -233,6 +271,21 @@ wasm_store_t* wasm_store_new(wasm_engine_t* engine) {
   return release_store(Store::make(engine));
 };
 
+static_assert(
+  sizeof(wasm_store_counters_t) == sizeof(Store::Counters),
+  "C/C++ incompatibility"
+);
+
+void wasm_store_counters(
+  const wasm_store_t* store, wasm_store_counters_t* out
+) {
+  *out = *reinterpret_cast<const wasm_store_counters_t*>(&store->counters());
+}
+
+bool wasm_store_pump(wasm_store_t* store, bool wait) {
+  return store->pump(wait);
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Type Representations
@@ -740,6 +793,30 @@ wasm_module_t* wasm_module_new(
   return release_module(Module::make(store, binary_.it));
 }
 
+extern "C++" {
+
+struct wasm_compile_env_t {
+  wasm_module_compile_callback_t callback;
+  void* env;
+};
+
+void wasm_compile_callback(void* env, own<Module>&& module) {
+  auto t = static_cast<wasm_compile_env_t*>(env);
+  t->callback(t->env, release_module(std::move(module)));
+  delete t;
+}
+
+}  // extern "C++"
+
+void wasm_module_compile_async(
+  wasm_store_t* store, const wasm_byte_vec_t* binary,
+  wasm_module_compile_callback_t callback, void* env
+) {
+  auto binary_ = borrow_byte_vec(binary);
+  auto env2 = new wasm_compile_env_t{callback, env};
+  Module::compile_async(store, binary_.it, wasm_compile_callback, env2);
+}
+
 
 void wasm_module_imports(
   const wasm_module_t* module, wasm_importtype_vec_t* out
@@ -753,6 +830,14 @@ void wasm_module_exports(
   *out = release_exporttype_vec(reveal_module(module)->exports());
 }
 
+WASM_DEFINE_VEC_PLAIN(func_tier, Module::FuncTier)
+
+void wasm_module_func_tiers(
+  const wasm_module_t* module, wasm_func_tier_vec_t* out
+) {
+  *out = release_func_tier_vec(reveal_module(module)->func_tiers());
+}
+
 void wasm_module_serialize(const wasm_module_t* module, wasm_byte_vec_t* out) {
   *out = release_byte_vec(reveal_module(module)->serialize());
 }
@@ -764,6 +849,12 @@ wasm_module_t* wasm_module_deserialize(
   return release_module(Module::deserialize(store, binary_.it));
 }
 
+wasm_module_t* wasm_module_deserialize_mapped(
+  wasm_store_t* store, const char* path
+) {
+  return release_module(Module::deserialize_mapped(store, path));
+}
+
 wasm_shared_module_t* wasm_module_share(const wasm_module_t* module) {
   return release_shared_module(reveal_module(module)->share());
 }
@@ -773,6 +864,25 @@ wasm_module_t* wasm_module_obtain(wasm_store_t* store, const wasm_shared_module_
 }
 
 
+// Streaming Compilation
+
+WASM_DEFINE_OWN(module_stream, ModuleStream)
+
+wasm_module_stream_t* wasm_module_stream_new(wasm_store_t* store) {
+  return release_module_stream(ModuleStream::make(store));
+}
+
+bool wasm_module_stream_push(
+  wasm_module_stream_t* stream, const wasm_byte_t* data, size_t size
+) {
+  return stream->push(data, size);
+}
+
+wasm_module_t* wasm_module_stream_finish(wasm_module_stream_t* stream) {
+  return release_module(stream->finish());
+}
+
+
 // Function Instances
 
 WASM_DEFINE_REF(func, Func)
@@ -805,6 +915,26 @@ void wasm_callback_env_finalizer(void* env) {
   delete t;
 }
 
+struct wasm_callback_raw_env_t {
+  wasm_func_callback_raw_t callback;
+  void* env;
+  void (*finalizer)(void*);
+};
+
+auto wasm_callback_raw(
+  void* env, const Val args[], Val results[]
+) -> own<Trap> {
+  auto t = static_cast<wasm_callback_raw_env_t*>(env);
+  return adopt_trap(t->callback(
+    t->env, hide_val_vec(args), hide_val_vec(results)));
+}
+
+void wasm_callback_raw_env_finalizer(void* env) {
+  auto t = static_cast<wasm_callback_raw_env_t*>(env);
+  if (t->finalizer) t->finalizer(t->env);
+  delete t;
+}
+
 }  // extern "C++"
 
 wasm_func_t* wasm_func_new(
@@ -823,6 +953,31 @@ wasm_func_t *wasm_func_new_with_env(
   return release_func(Func::make(store, type, wasm_callback_with_env, env2, wasm_callback_env_finalizer));
 }
 
+wasm_func_t *wasm_func_new_raw(
+  wasm_store_t* store, const wasm_functype_t* type,
+  wasm_func_callback_raw_t callback, void *env, void (*finalizer)(void*)
+) {
+  auto env2 = new wasm_callback_raw_env_t{callback, env, finalizer};
+  return release_func(Func::make(store, type, wasm_callback_raw, env2, wasm_callback_raw_env_finalizer));
+}
+
+void wasm_func_new_batch(
+  wasm_store_t* store, size_t size, const wasm_func_spec_t specs[],
+  wasm_func_t* out[]
+) {
+  auto specs2 = vec<Func::Spec>::make_uninitialized(size);
+  for (size_t i = 0; i < size; ++i) {
+    auto env2 = new wasm_callback_env_t{
+      specs[i].callback, specs[i].env, specs[i].finalizer};
+    specs2[i] = Func::Spec{
+      specs[i].type, wasm_callback_with_env, env2, wasm_callback_env_finalizer};
+  }
+  auto funcs = Func::make_batch(store, specs2);
+  for (size_t i = 0; i < size; ++i) {
+    out[i] = funcs ? release_func(std::move(funcs[i])) : nullptr;
+  }
+}
+
 wasm_functype_t* wasm_func_type(const wasm_func_t* func) {
   return release_functype(func->type());
 }
@@ -843,6 +998,13 @@ wasm_trap_t* wasm_func_call(
   return release_trap(func->call(args_.it, results_.it));
 }
 
+wasm_trap_t* wasm_func_call_unchecked(
+  const wasm_func_t* func, const wasm_val_t args[], wasm_val_t results[]
+) {
+  return release_trap(
+    func->call_unchecked(reveal_val_vec(args), reveal_val_vec(results)));
+}
+
 
 // Global Instances
 
@@ -868,6 +1030,32 @@ void wasm_global_set(wasm_global_t* global, const wasm_val_t* val) {
   global->set(val_.it);
 }
 
+int32_t wasm_global_get_i32(const wasm_global_t* global) {
+  return global->get_i32();
+}
+int64_t wasm_global_get_i64(const wasm_global_t* global) {
+  return global->get_i64();
+}
+float32_t wasm_global_get_f32(const wasm_global_t* global) {
+  return global->get_f32();
+}
+float64_t wasm_global_get_f64(const wasm_global_t* global) {
+  return global->get_f64();
+}
+
+void wasm_global_set_i32(wasm_global_t* global, int32_t val) {
+  global->set_i32(val);
+}
+void wasm_global_set_i64(wasm_global_t* global, int64_t val) {
+  global->set_i64(val);
+}
+void wasm_global_set_f32(wasm_global_t* global, float32_t val) {
+  global->set_f32(val);
+}
+void wasm_global_set_f64(wasm_global_t* global, float64_t val) {
+  global->set_f64(val);
+}
+
 
 // Table Instances
 
@@ -934,6 +1122,24 @@ bool wasm_memory_grow(wasm_memory_t* memory, wasm_memory_pages_t delta) {
   return memory->grow(delta);
 }
 
+WASM_DEFINE_OWN(memory_snapshot, MemorySnapshot)
+
+wasm_memory_snapshot_t* wasm_memory_snapshot(const wasm_memory_t* memory) {
+  return release_memory_snapshot(memory->snapshot());
+}
+
+bool wasm_memory_restore(
+  wasm_memory_t* memory, const wasm_memory_snapshot_t* snapshot
+) {
+  return memory->restore(snapshot);
+}
+
+wasm_memory_pages_t wasm_memory_snapshot_size(
+  const wasm_memory_snapshot_t* snapshot
+) {
+  return snapshot->size();
+}
+
 
 // Externals
 
@@ -1024,6 +1230,61 @@ void wasm_instance_exports(
   *out = release_extern_vec(instance->exports());
 }
 
+wasm_extern_t* wasm_instance_export_by_name(
+  const wasm_instance_t* instance, const wasm_name_t* name
+) {
+  auto name_ = borrow_byte_vec(name);
+  return release_extern(instance->export_by_name(name_.it));
+}
+
+wasm_extern_t* wasm_instance_export_by_index(
+  const wasm_instance_t* instance, size_t index
+) {
+  return release_extern(instance->export_by_index(index));
+}
+
+
+// Instance Pools
+
+WASM_DEFINE_OWN(instance_pool, InstancePool)
+
+wasm_instance_pool_t* wasm_instance_pool_new(
+  wasm_store_t* store,
+  const wasm_module_t* module,
+  const wasm_extern_vec_t* imports,
+  size_t size,
+  wasm_trap_t** trap
+) {
+  own<Trap> error;
+  auto imports_ = reveal_extern_vec(imports);
+  auto pool = release_instance_pool(
+    InstancePool::make(store, module, *imports_, size, &error));
+  if (trap) *trap = hide_trap(error.release());
+  return pool;
+}
+
+wasm_instance_t* wasm_instance_pool_acquire(wasm_instance_pool_t* pool) {
+  return release_instance(pool->acquire());
+}
+
+void wasm_instance_pool_release(
+  wasm_instance_pool_t* pool, wasm_instance_t* instance
+) {
+  pool->release(adopt_instance(instance));
+}
+
+static_assert(
+  sizeof(wasm_instance_pool_metrics_t) == sizeof(InstancePool::Metrics),
+  "C/C++ incompatibility"
+);
+
+void wasm_instance_pool_metrics(
+  const wasm_instance_pool_t* pool, wasm_instance_pool_metrics_t* out
+) {
+  *out = *reinterpret_cast<const wasm_instance_pool_metrics_t*>(
+    &pool->metrics());
+}
+
 
 wasm_instance_t* wasm_frame_instance(const wasm_frame_t* frame) {
   return hide_instance(reveal_frame(frame)->instance());
@@ -14,6 +14,7 @@
 
 #include "api/api.h"
 #include "api/api-inl.h"
+#include "wasm/wasm-code-manager.h"
 #include "wasm/wasm-objects.h"
 #include "wasm/wasm-objects-inl.h"
 #include "wasm/wasm-serialization.h"
@@ -254,6 +255,29 @@ auto module_deserialize(
   return v8::MaybeLocal<v8::Object>(v8::Utils::ToLocal(v8_module));
 }
 
+auto module_func_count(v8::Local<v8::Object> module) -> uint32_t {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(module);
+  auto v8_module = v8::internal::Handle<v8::internal::WasmModuleObject>::cast(v8_object);
+  return v8_module->native_module()->num_functions();
+}
+
+void module_func_tiers(v8::Local<v8::Object> module, func_tier_t tiers[]) {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(module);
+  auto v8_module = v8::internal::Handle<v8::internal::WasmModuleObject>::cast(v8_object);
+  auto native_module = v8_module->native_module();
+  auto num_imported = native_module->num_imported_functions();
+  for (uint32_t i = 0; i < num_imported; ++i) tiers[i] = FUNC_TIER_NONE;
+  // Background tier-up and lazy compilation write the code table
+  // concurrently, so it is copied under the native module's lock. Lazily
+  // compiled functions have no code until their first call.
+  auto code_table = native_module->SnapshotCodeTable();
+  for (size_t i = 0; i < code_table.size(); ++i) {
+    auto code = code_table[i];
+    tiers[num_imported + i] = code == nullptr ? FUNC_TIER_NONE
+      : code->is_liftoff() ? FUNC_TIER_BASELINE : FUNC_TIER_OPTIMIZED;
+  }
+}
+
 
 // Instances
 
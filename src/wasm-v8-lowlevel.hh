@@ -44,6 +44,10 @@ auto module_serialize_size(v8::Local<v8::Object> module) -> size_t;
 auto module_serialize(v8::Local<v8::Object> module, char*, size_t) -> bool;
 auto module_deserialize(v8::Isolate*, const char*, size_t, const char*, size_t) -> v8::MaybeLocal<v8::Object>;
 
+enum func_tier_t { FUNC_TIER_NONE, FUNC_TIER_BASELINE, FUNC_TIER_OPTIMIZED };
+auto module_func_count(v8::Local<v8::Object> module) -> uint32_t;
+void module_func_tiers(v8::Local<v8::Object> module, func_tier_t tiers[]);
+
 auto instance_module(v8::Local<v8::Object> instance) -> v8::Local<v8::Object>;
 auto instance_exports(v8::Local<v8::Object> instance) -> v8::Local<v8::Object>;
 
@@ -5,12 +5,32 @@
 #include "v8.h"
 #include "libplatform/libplatform.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
 #include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #ifdef WASM_API_DEBUG
 #include <atomic>
 #endif
 
+// Memory-mapped deserialization and the code cache need POSIX; elsewhere,
+// files are read into memory and the cache is disabled.
+#if defined(__unix__) || defined(__APPLE__)
+#define WASM_V8_POSIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
 
 namespace wasm_v8 {
   using namespace v8::wasm;
@@ -24,6 +44,12 @@ namespace v8 {
     extern bool FLAG_experimental_wasm_anyref;
     extern bool FLAG_experimental_wasm_bulk_memory;
     extern bool FLAG_experimental_wasm_return_call;
+    extern bool FLAG_optimize_for_size;
+    extern size_t FLAG_initial_old_space_size;
+    extern bool FLAG_liftoff;
+    extern bool FLAG_wasm_tier_up;
+    extern bool FLAG_wasm_lazy_compilation;
+    extern int FLAG_wasm_num_compilation_tasks;
   }
 }
 
@@ -74,6 +100,7 @@ struct Stats {
     EXTERNTYPE, IMPORTTYPE, EXPORTTYPE,
     VAL, REF, TRAP,
     MODULE, INSTANCE, FUNC, GLOBAL, TABLE, MEMORY, EXTERN,
+    FUNCSPEC, INSTANCEPOOL, MEMORYSNAPSHOT, MODULESTREAM,
     STRONG_COUNT,
     FUNCDATA_FUNCTYPE, FUNCDATA_VALTYPE,
     CATEGORY_COUNT
@@ -158,11 +185,8 @@ struct Stats {
 #endif
   }
 
-  static category_t categorize(const v8::Persistent<v8::Object>& pobj) {
+  static category_t categorize(v8::Local<v8::Object> obj) {
 #ifdef WASM_API_DEBUG
-    auto isolate = wasm_v8::object_isolate(pobj);
-    v8::HandleScope handle_scope(isolate);
-    auto obj = pobj.Get(isolate);
     if (wasm_v8::object_is_func(obj)) return FUNC;
     if (wasm_v8::object_is_global(obj)) return GLOBAL;
     if (wasm_v8::object_is_table(obj)) return TABLE;
@@ -181,7 +205,8 @@ const char* Stats::name[STRONG_COUNT] = {
   "ValType", "FuncType", "GlobalType", "TableType", "MemoryType",
   "ExternType", "ImportType", "ExportType",
   "Val", "Ref", "Trap",
-  "Module", "Instance", "Func", "Global", "Table", "Memory", "Extern"
+  "Module", "Instance", "Func", "Global", "Table", "Memory", "Extern",
+  "Func::Spec", "InstancePool", "MemorySnapshot", "ModuleStream"
 };
 
 const char* Stats::left[CARDINALITY_COUNT] = {
@@ -231,6 +256,7 @@ DEFINE_VEC(Memory, ownvec, MEMORY)
 DEFINE_VEC(Extern, ownvec, EXTERN)
 DEFINE_VEC(Extern*, vec, EXTERN)
 DEFINE_VEC(Val, vec, VAL)
+DEFINE_VEC(Func::Spec, vec, FUNCSPEC)
 
 #endif  // #ifdef WASM_API_DEBUG
 
@@ -241,6 +267,16 @@ DEFINE_VEC(Val, vec, VAL)
 // Configuration
 
 struct ConfigImpl {
+  size_t max_old_space_size = 0;
+  size_t max_semi_space_size = 0;
+  size_t code_range_size = 0;
+  size_t initial_old_space_size = 0;
+  bool optimize_for_memory = false;
+  Config::CompileMode compile_mode = Config::CompileMode::TIERED;
+  size_t compile_workers = 0;
+  std::string cache_directory;
+  size_t cache_size_limit = 0;
+
   ConfigImpl() { stats.make(Stats::CONFIG, this); }
   ~ConfigImpl() { stats.free(Stats::CONFIG, this); }
 };
@@ -260,13 +296,59 @@ auto Config::make() -> own<Config> {
   return own<Config>(seal<Config>(new(std::nothrow) ConfigImpl()));
 }
 
+void Config::set_max_old_space_size(size_t size) {
+  impl(this)->max_old_space_size = size;
+}
+
+void Config::set_max_semi_space_size(size_t size) {
+  impl(this)->max_semi_space_size = size;
+}
+
+void Config::set_code_range_size(size_t size) {
+  impl(this)->code_range_size = size;
+}
+
+void Config::set_initial_old_space_size(size_t size) {
+  impl(this)->initial_old_space_size = size;
+}
+
+void Config::set_optimize_for_memory(bool enable) {
+  impl(this)->optimize_for_memory = enable;
+}
+
+void Config::set_compile_mode(CompileMode mode) {
+  impl(this)->compile_mode = mode;
+}
+
+void Config::set_compile_workers(size_t workers) {
+  impl(this)->compile_workers = workers;
+}
+
+void Config::set_cache_directory(const char* path) {
+  impl(this)->cache_directory = path ? path : "";
+}
+
+void Config::set_cache_size_limit(size_t size) {
+  impl(this)->cache_size_limit = size;
+}
+
 
 // Engine
 
+// V8 takes sizes in MB or KB, rounded up here.
+auto mb(size_t bytes) -> size_t {
+  return (bytes + (1 << 20) - 1) >> 20;
+}
+
+auto kb(size_t bytes) -> size_t {
+  return (bytes + (1 << 10) - 1) >> 10;
+}
+
 struct EngineImpl {
   static bool created;
 
   std::unique_ptr<v8::Platform> platform;
+  own<Config> config;
 
   EngineImpl() {
     assert(!created);
@@ -295,18 +377,50 @@ void Engine::operator delete(void *p) {
 }
 
 auto Engine::make(own<Config>&& config) -> own<Engine> {
+  if (!config) return own<Engine>();
   v8::internal::FLAG_expose_gc = true;
   v8::internal::FLAG_experimental_wasm_bigint = true;
   v8::internal::FLAG_experimental_wasm_mv = true;
   v8::internal::FLAG_experimental_wasm_anyref = true;
   v8::internal::FLAG_experimental_wasm_bulk_memory = true;
   v8::internal::FLAG_experimental_wasm_return_call = true;
+  auto config_impl = impl(config.get());
+  if (config_impl->initial_old_space_size > 0) {
+    v8::internal::FLAG_initial_old_space_size =
+      mb(config_impl->initial_old_space_size);
+  }
+  if (config_impl->optimize_for_memory) {
+    v8::internal::FLAG_optimize_for_size = true;
+  }
+  switch (config_impl->compile_mode) {
+    case Config::CompileMode::TIERED:
+      v8::internal::FLAG_liftoff = true;
+      v8::internal::FLAG_wasm_tier_up = true;
+      break;
+    case Config::CompileMode::BASELINE:
+      v8::internal::FLAG_liftoff = true;
+      v8::internal::FLAG_wasm_tier_up = false;
+      break;
+    case Config::CompileMode::OPTIMIZED:
+      v8::internal::FLAG_liftoff = false;
+      v8::internal::FLAG_wasm_tier_up = false;
+      break;
+    case Config::CompileMode::LAZY:
+      v8::internal::FLAG_wasm_lazy_compilation = true;
+      break;
+  }
+  if (config_impl->compile_workers > 0) {
+    v8::internal::FLAG_wasm_num_compilation_tasks =
+      static_cast<int>(config_impl->compile_workers);
+  }
   // v8::V8::SetFlagsFromCommandLine(&argc, const_cast<char**>(argv), false);
   auto engine = new(std::nothrow) EngineImpl;
   if (!engine) return own<Engine>();
+  engine->config = std::move(config);
   // v8::V8::InitializeICUDefaultLocation(argv[0]);
   // v8::V8::InitializeExternalStartupData(argv[0]);
-  engine->platform = v8::platform::NewDefaultPlatform();
+  engine->platform = v8::platform::NewDefaultPlatform(
+    static_cast<int>(config_impl->compile_workers));
   v8::V8::InitializePlatform(engine->platform.get());
   v8::V8::Initialize();
   return make_own(seal<Engine>(engine));
@@ -327,25 +441,184 @@ enum v8_symbol_t {
   V8_Y_COUNT
 };
 
+enum v8_private_t {
+  V8_P_MODULE_DATA, V8_P_IMPORT_PLAN, V8_P_POOL_REFS,
+  V8_P_COUNT
+};
+
 enum v8_function_t {
-  V8_F_WEAKMAP, V8_F_WEAKMAP_PROTO, V8_F_WEAKMAP_GET, V8_F_WEAKMAP_SET,
   V8_F_MODULE, V8_F_GLOBAL, V8_F_TABLE, V8_F_MEMORY,
-  V8_F_INSTANCE, V8_F_VALIDATE,
+  V8_F_INSTANCE, V8_F_VALIDATE, V8_F_COMPILE, V8_F_COMPILE_STREAMING,
   V8_F_COUNT,
 };
 
+struct HandleChunk;
+
+// Handles backing references, pooled per store.
+struct CallStub;
+
+struct RefHandle : v8::Persistent<v8::Object> {
+  union {
+    // Canonical type of the referenced external, cached on first use.
+    // Owned by the store.
+    mutable const ExternType* type = nullptr;
+    // Next free handle in the chunk, while unused.
+    RefHandle* next_free;
+  };
+  // Call stub for the type of a referenced function, cached on first call.
+  // Owned by the store.
+  mutable const CallStub* stub = nullptr;
+  HandleChunk* chunk = nullptr;
+};
+
+// Handles are allocated in fixed-size chunks, each with its own free list,
+// so that a chunk whose handles are all free can be released.
+struct HandleChunk {
+  static const size_t size = 128;
+
+  HandleChunk* prev = nullptr;  // in the store's list of non-full chunks
+  HandleChunk* next = nullptr;
+  RefHandle* free = nullptr;
+  size_t live = 0;
+  RefHandle handles[size];
+
+  HandleChunk() {
+    for (size_t i = size; i > 0; --i) {
+      handles[i - 1].chunk = this;
+      handles[i - 1].next_free = free;
+      free = &handles[i - 1];
+    }
+  }
+};
+
+class StoreImpl;
+
+// Host info attached to an object, held weakly and finalized when the object
+// dies.
+struct HostInfo {
+  StoreImpl* store;
+  int hash;
+  v8::Global<v8::Object> object;
+  void* info;
+  void (*finalizer)(void*);
+};
+
+// A pending Module::compile_async.
+struct CompileJob {
+  Module::compile_callback callback;
+  void* env;
+};
+
+// Handles for references borrowed by a host callback, only valid until it
+// returns. They point into the callback's handle scope instead of holding a
+// global handle, and are told apart from pooled handles by having no chunk.
+struct BorrowedHandle : RefHandle {
+  StoreImpl* store = nullptr;
+  v8::Local<v8::Object> local;
+};
+
+// Argument and result converters specialised to one function signature,
+// so that calls need not dispatch on value kinds. Signatures whose params or
+// results all have the same kind convert them in one loop with the converter
+// inlined; others call a converter per value.
+struct CallStub {
+  using param_t = auto (*)(StoreImpl*, const Val&) -> v8::Local<v8::Value>;
+  using result_t = void (*)(StoreImpl*, v8::Local<v8::Value>, Val*);
+  using params_t = void (*)(
+    StoreImpl*, const CallStub*, const Val[], v8::Local<v8::Value>[]);
+  using results_t = void (*)(
+    StoreImpl*, const CallStub*, v8::Local<v8::Value>, Val[]);
+
+  size_t num_params;
+  size_t num_results;
+  params_t convert_params;
+  results_t convert_results;
+  std::vector<param_t> params;  // if params are mixed
+  std::vector<result_t> results;  // if results are mixed
+};
+
 class StoreImpl {
   friend own<Store> Store::make(Engine*);
 
+  EngineImpl* engine_;
   v8::Isolate::CreateParams create_params_;
   v8::Isolate *isolate_;
   v8::Eternal<v8::Context> context_;
   v8::Eternal<v8::String> strings_[V8_S_COUNT];
   v8::Eternal<v8::Symbol> symbols_[V8_Y_COUNT];
+  v8::Eternal<v8::Private> privates_[V8_P_COUNT];
   v8::Eternal<v8::Function> functions_[V8_F_COUNT];
-  v8::Eternal<v8::Object> host_data_map_;
   v8::Eternal<v8::Symbol> callback_symbol_;
-  v8::Persistent<v8::Object>* handle_pool_ = nullptr;  // TODO: use v8::Value
+  std::vector<HandleChunk*> handle_chunks_;
+  HandleChunk* handle_pool_ = nullptr;  // chunks with free handles
+  std::deque<BorrowedHandle> borrowed_;
+  size_t borrowed_depth_ = 0;
+  std::unordered_multimap<int, own<HostInfo>> host_infos_;
+  std::unordered_set<CompileJob*> compile_jobs_;
+  std::unordered_map<std::string, own<FuncType>> func_types_;
+  std::unordered_map<const FuncType*, own<CallStub>> call_stubs_;
+  std::unordered_map<const FuncType*, own<Module>> func_wrappers_;
+  std::unordered_map<uint32_t, own<GlobalType>> global_types_;
+  std::unordered_map<uint32_t, own<Module>> global_wrappers_;
+  std::vector<v8::Local<v8::Value>> v8_args_;
+  std::vector<vec<Val>> val_frames_;
+  size_t val_depth_ = 0;
+  Store::Counters counters_ = {};
+
+  void link_chunk(HandleChunk* chunk, bool front) {
+    if (front || handle_pool_ == nullptr) {
+      chunk->prev = handle_pool_ ? handle_pool_->prev : chunk;
+      chunk->next = handle_pool_;
+      if (handle_pool_) handle_pool_->prev = chunk;
+      handle_pool_ = chunk;
+    } else {
+      auto last = handle_pool_->prev;
+      chunk->prev = last;
+      chunk->next = nullptr;
+      last->next = chunk;
+      handle_pool_->prev = chunk;
+    }
+  }
+
+  void unlink_chunk(HandleChunk* chunk) {
+    if (chunk == handle_pool_) {
+      handle_pool_ = chunk->next;
+      if (handle_pool_) handle_pool_->prev = chunk->prev;
+    } else {
+      chunk->prev->next = chunk->next;
+      (chunk->next ? chunk->next : handle_pool_)->prev = chunk->prev;
+    }
+    chunk->prev = chunk->next = nullptr;
+  }
+
+  auto grow_handles() -> bool {
+    auto chunk = new(std::nothrow) HandleChunk();
+    if (!chunk) return false;
+    handle_chunks_.push_back(chunk);
+    link_chunk(chunk, true);
+    counters_.handles_free += HandleChunk::size;
+    ++counters_.handle_chunks_allocated;
+    return true;
+  }
+
+  // Empty chunks sit at the back of the pool.
+  void shrink_handles() {
+    while (counters_.handles_free > handles_low_watermark) {
+      auto chunk = handle_pool_->prev;
+      if (chunk->live > 0) break;
+      unlink_chunk(chunk);
+      for (auto& c : handle_chunks_) {
+        if (c == chunk) {
+          c = handle_chunks_.back();
+          handle_chunks_.pop_back();
+          break;
+        }
+      }
+      delete chunk;
+      counters_.handles_free -= HandleChunk::size;
+      ++counters_.handle_chunks_released;
+    }
+  }
 
 public:
   StoreImpl() {
@@ -353,19 +626,25 @@ public:
   }
 
   ~StoreImpl() {
+    for (auto job : compile_jobs_) {
+      job->callback(job->env, nullptr);
+      delete job;
+    }
+    compile_jobs_.clear();
+    global_wrappers_.clear();
+    func_wrappers_.clear();
+    call_stubs_.clear();
+    global_types_.clear();
+    func_types_.clear();
+    for (auto& entry : host_infos_) {
+      if (entry.second->finalizer) entry.second->finalizer(entry.second->info);
+    }
+    host_infos_.clear();
 #ifdef WASM_API_DEBUG
     isolate_->RequestGarbageCollectionForTesting(
       v8::Isolate::kFullGarbageCollection);
 #endif
-    {
-      v8::HandleScope scope(isolate_);
-      while (handle_pool_ != nullptr) {
-        auto handle = handle_pool_;
-        handle_pool_ = reinterpret_cast<v8::Persistent<v8::Object>*>(
-          wasm_v8::foreign_get(handle->Get(isolate_)));
-        delete handle;
-      }
-    }
+    for (auto chunk : handle_chunks_) delete chunk;
     context()->Exit();
     isolate_->Exit();
     isolate_->Dispose();
@@ -373,6 +652,10 @@ public:
     stats.free(Stats::STORE, this);
   }
 
+  auto engine() const -> EngineImpl* {
+    return engine_;
+  }
+
   auto isolate() const -> v8::Isolate* {
     return isolate_;
   }
@@ -387,39 +670,197 @@ public:
   auto v8_string(v8_symbol_t i) const -> v8::Local<v8::Symbol> {
     return symbols_[i].Get(isolate_);
   }
+  auto v8_private(v8_private_t i) const -> v8::Local<v8::Private> {
+    return privates_[i].Get(isolate_);
+  }
   auto v8_function(v8_function_t i) const -> v8::Local<v8::Function> {
     return functions_[i].Get(isolate_);
   }
 
-  auto host_data_map() const -> v8::Local<v8::Object> {
-    return host_data_map_.Get(isolate_);
+  // Host info is kept in a table keyed by the objects' identity hash, so
+  // that looking it up requires no call into JS.
+  auto host_info(v8::Local<v8::Object> obj) -> HostInfo* {
+    auto range = host_infos_.equal_range(obj->GetIdentityHash());
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second->object == obj) return it->second.get();
+    }
+    return nullptr;
+  }
+
+  void set_host_info(
+    v8::Local<v8::Object> obj, void* info, void (*finalizer)(void*)
+  ) {
+    auto entry = host_info(obj);
+    if (entry) {
+      if (entry->finalizer && entry->info != info) {
+        entry->finalizer(entry->info);
+      }
+      entry->info = info;
+      entry->finalizer = finalizer;
+      return;
+    }
+    auto new_entry = make_own(new(std::nothrow) HostInfo());
+    if (!new_entry) return;
+    new_entry->store = this;
+    new_entry->hash = obj->GetIdentityHash();
+    new_entry->object.Reset(isolate_, obj);
+    new_entry->object.SetWeak(new_entry.get(),
+      &StoreImpl::host_info_weak, v8::WeakCallbackType::kParameter);
+    new_entry->info = info;
+    new_entry->finalizer = finalizer;
+    host_infos_.emplace(new_entry->hash, std::move(new_entry));
+  }
+
+  static void host_info_weak(const v8::WeakCallbackInfo<HostInfo>& data) {
+    auto entry = data.GetParameter();
+    entry->object.Reset();
+    auto& infos = entry->store->host_infos_;
+    auto range = infos.equal_range(entry->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.get() == entry) {
+        it->second.release();
+        infos.erase(it);
+        break;
+      }
+    }
+    // The finalizer is host code, which may not run in the first pass.
+    data.SetSecondPassCallback(&StoreImpl::host_info_finalize);
+  }
+
+  static void host_info_finalize(const v8::WeakCallbackInfo<HostInfo>& data) {
+    auto entry = data.GetParameter();
+    if (entry->finalizer) entry->finalizer(entry->info);
+    delete entry;
   }
 
   static auto get(v8::Isolate* isolate) -> StoreImpl* {
     return static_cast<StoreImpl*>(isolate->GetData(0));
   }
 
-  auto make_handle() -> v8::Persistent<v8::Object>* {
+  // Empty chunks are released once more than the high watermark of free
+  // handles accumulates, until no more than the low watermark remain.
+  static const size_t handles_low_watermark = 2 * HandleChunk::size;
+  static const size_t handles_high_watermark = 8 * HandleChunk::size;
+
+  auto make_handle() -> RefHandle* {
     if (handle_pool_ == nullptr) {
-      static const size_t n = 100;
-      for (size_t i = 0; i < n; ++i) {
-        auto v8_next = wasm_v8::foreign_new(isolate_, handle_pool_);
-        handle_pool_ = new(std::nothrow) v8::Persistent<v8::Object>();
-        if (!handle_pool_) return nullptr;
-        handle_pool_->Reset(isolate_, v8::Local<v8::Object>::Cast(v8_next));
-      }
+      if (!grow_handles()) return nullptr;
+    }
+    auto chunk = handle_pool_;
+    auto handle = chunk->free;
+    chunk->free = handle->next_free;
+    handle->type = nullptr;
+    handle->stub = nullptr;
+    if (chunk->free == nullptr) unlink_chunk(chunk);
+    ++chunk->live;
+    --counters_.handles_free;
+    if (++counters_.handles_live > counters_.handles_peak) {
+      counters_.handles_peak = counters_.handles_live;
     }
-    auto handle = handle_pool_;
-    handle_pool_ = reinterpret_cast<v8::Persistent<v8::Object>*>(
-      wasm_v8::foreign_get(handle->Get(isolate_)));
     return handle;
   }
 
-  void free_handle(v8::Persistent<v8::Object>* handle) {
-    // TODO: shrink pool?
-    auto next = wasm_v8::foreign_new(isolate_, handle_pool_);
-    handle->Reset(isolate_, v8::Local<v8::Object>::Cast(next));
-    handle_pool_ = handle;
+  void free_handle(RefHandle* handle) {
+    auto chunk = handle->chunk;
+    handle->Reset();
+    if (chunk->free == nullptr) link_chunk(chunk, true);
+    handle->next_free = chunk->free;
+    chunk->free = handle;
+    --counters_.handles_live;
+    ++counters_.handles_free;
+    if (--chunk->live == 0) {
+      // Move empty chunks to the back, so that they are reused last.
+      unlink_chunk(chunk);
+      link_chunk(chunk, false);
+      if (counters_.handles_free > handles_high_watermark) shrink_handles();
+    }
+  }
+
+  // Compilations started but not yet completed.
+  void start_compile(CompileJob* job) {
+    compile_jobs_.insert(job);
+  }
+
+  void finish_compile(CompileJob* job) {
+    compile_jobs_.erase(job);
+  }
+
+  auto compiles_pending() const -> bool {
+    return !compile_jobs_.empty();
+  }
+
+  // Borrowed handles are stacked, and released in bulk by resetting the
+  // depth to a mark taken before the callback.
+  auto borrow_handle(v8::Local<v8::Object> obj) -> RefHandle* {
+    if (borrowed_depth_ == borrowed_.size()) borrowed_.emplace_back();
+    auto handle = &borrowed_[borrowed_depth_++];
+    handle->store = this;
+    handle->local = obj;
+    handle->type = nullptr;
+    handle->stub = nullptr;
+    ++counters_.refs_borrowed;
+    return handle;
+  }
+
+  auto borrowed_mark() const -> size_t {
+    return borrowed_depth_;
+  }
+
+  void release_borrowed(size_t mark) {
+    borrowed_depth_ = mark;
+  }
+
+  // Canonical function types, one per distinct signature in this store.
+  auto func_type(const FuncType* type) -> const FuncType*;
+
+  // Canonical global types, one per content kind and mutability.
+  auto global_type(ValKind kind, Mutability mutability) -> const GlobalType*;
+
+  // Call stubs, keyed by canonical function type.
+  auto call_stub(const FuncType* type) -> const CallStub*;
+
+  // Compiled wrapper modules for host functions, one per signature.
+  auto func_wrapper(const FuncType* type) -> const Module*;
+
+  // Compiled wrapper modules for globals, one per content kind and
+  // mutability.
+  auto global_wrapper(const GlobalType* type) -> const Module*;
+
+  auto counters() -> Store::Counters& {
+    return counters_;
+  }
+
+  // Scratch space for call arguments and other short-lived handles. A store
+  // is only used by one thread, and V8 has consumed the handles before any
+  // reentrant call can occur.
+  auto v8_args(size_t n) -> v8::Local<v8::Value>* {
+    if (v8_args_.size() < n) v8_args_.resize(n);
+    return v8_args_.data();
+  }
+
+  // Scratch frames for host callback arguments and results, one per level
+  // of reentrancy, so that warmed up callbacks do not allocate.
+  auto push_vals(size_t n) -> Val* {
+    if (val_frames_.size() == val_depth_) {
+      val_frames_.push_back(vec<Val>::make());
+    }
+    auto& frame = val_frames_[val_depth_++];
+    if (!frame || frame.size() < n) {
+      frame = vec<Val>::make_uninitialized(n);
+    }
+    return frame.get();
+  }
+
+  void pop_vals(Val* vals, size_t n) {
+    for (size_t i = 0; i < n; ++i) vals[i].reset();
+    --val_depth_;
+  }
+
+  // Forgets the top frame after its storage was taken over by a callback.
+  void drop_vals() {
+    auto& frame = val_frames_[--val_depth_];
+    frame.release();
+    frame = vec<Val>::make();
   }
 };
 
@@ -434,15 +875,49 @@ void Store::operator delete(void *p) {
   ::operator delete(p);
 }
 
-auto Store::make(Engine*) -> own<Store> {
+auto Store::counters() const -> const Counters& {
+  return const_cast<StoreImpl*>(impl(this))->counters();
+}
+
+auto Store::pump(bool wait) -> bool {
+  auto store = impl(this);
+  auto isolate = store->isolate();
+  auto platform = store->engine()->platform.get();
+  v8::HandleScope handle_scope(isolate);
+  if (wait && store->compiles_pending()) {
+    v8::platform::PumpMessageLoop(platform, isolate,
+      v8::platform::MessageLoopBehavior::kWaitForWork);
+  }
+  while (v8::platform::PumpMessageLoop(platform, isolate)) {}
+  isolate->RunMicrotasks();
+  return store->compiles_pending();
+}
+
+void streaming_callback(const v8::FunctionCallbackInfo<v8::Value>&);
+
+auto Store::make(Engine* engine) -> own<Store> {
   auto store = make_own(new(std::nothrow) StoreImpl());
   if (!store) return own<Store>();
+  store->engine_ = impl(engine);
 
   // Create isolate.
   store->create_params_.array_buffer_allocator =
     v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+  auto config = impl(store->engine_->config.get());
+  auto& constraints = store->create_params_.constraints;
+  if (config->max_old_space_size > 0) {
+    constraints.set_max_old_space_size(mb(config->max_old_space_size));
+  }
+  if (config->max_semi_space_size > 0) {
+    constraints.set_max_semi_space_size_in_kb(kb(config->max_semi_space_size));
+  }
+  if (config->code_range_size > 0) {
+    constraints.set_code_range_size(mb(config->code_range_size));
+  }
   auto isolate = v8::Isolate::New(store->create_params_);
   if (!isolate) return own<Store>();
+  // Must be set before creating the context, to enable compileStreaming.
+  isolate->SetWasmStreamingCallback(&streaming_callback);
 
   {
     v8::Isolate::Scope isolate_scope(isolate);
@@ -475,6 +950,11 @@ auto Store::make(Engine*) -> own<Store> {
       store->symbols_[i] = v8::Eternal<v8::Symbol>(isolate, symbol);
     }
 
+    for (int i = 0; i < V8_P_COUNT; ++i) {
+      auto key = v8::Private::New(isolate);
+      store->privates_[i] = v8::Eternal<v8::Private>(isolate, key);
+    }
+
     // Extract functions.
     auto global = context->Global();
     auto maybe_wasm_name = v8::String::NewFromUtf8(isolate, "WebAssembly",
@@ -484,17 +964,14 @@ auto Store::make(Engine*) -> own<Store> {
     auto maybe_wasm = global->Get(context, wasm_name);
     if (maybe_wasm.IsEmpty()) return own<Store>();
     auto wasm = v8::Local<v8::Object>::Cast(maybe_wasm.ToLocalChecked());
-    v8::Local<v8::Object> weakmap;
-    v8::Local<v8::Object> weakmap_proto;
 
     struct {
       const char* name;
       v8::Local<v8::Object>* carrier;
     } raw_functions[V8_F_COUNT] = {
-      {"WeakMap", &global}, {"prototype", &weakmap},
-      {"get", &weakmap_proto}, {"set", &weakmap_proto},
       {"Module", &wasm}, {"Global", &wasm}, {"Table", &wasm}, {"Memory", &wasm},
-      {"Instance", &wasm}, {"validate", &wasm},
+      {"Instance", &wasm}, {"validate", &wasm}, {"compile", &wasm},
+      {"compileStreaming", &wasm},
     };
     for (int i = 0; i < V8_F_COUNT; ++i) {
       auto maybe_name = v8::String::NewFromUtf8(isolate, raw_functions[i].name,
@@ -507,25 +984,10 @@ auto Store::make(Engine*) -> own<Store> {
       auto maybe_obj = (*raw_functions[i].carrier)->Get(context, name);
       if (maybe_obj.IsEmpty()) return own<Store>();
       auto obj = v8::Local<v8::Object>::Cast(maybe_obj.ToLocalChecked());
-      if (i == V8_F_WEAKMAP_PROTO) {
-        assert(obj->IsObject());
-        weakmap_proto = obj;
-      } else {
-        assert(obj->IsFunction());
-        auto function = v8::Local<v8::Function>::Cast(obj);
-        store->functions_[i] = v8::Eternal<v8::Function>(isolate, function);
-        if (i == V8_F_WEAKMAP) weakmap = function;
-      }
+      assert(obj->IsFunction());
+      auto function = v8::Local<v8::Function>::Cast(obj);
+      store->functions_[i] = v8::Eternal<v8::Function>(isolate, function);
     }
-
-    // Create host data weak map.
-    v8::Local<v8::Value> empty_args[] = {};
-    auto maybe_weakmap =
-      store->v8_function(V8_F_WEAKMAP)->NewInstance(context, 0, empty_args);
-    if (maybe_weakmap.IsEmpty()) return own<Store>();
-    auto map = v8::Local<v8::Object>::Cast(maybe_weakmap.ToLocalChecked());
-    assert(map->IsWeakMap());
-    store->host_data_map_ = v8::Eternal<v8::Object>(isolate, map);
   }
 
   store->isolate()->Enter();
@@ -668,6 +1130,29 @@ auto FuncType::results() const -> const ownvec<ValType>& {
 }
 
 
+// Key identifying a function type structurally.
+auto signature(const FuncType* type) -> std::string {
+  auto& params = type->params();
+  auto& results = type->results();
+  std::string key;
+  key.reserve(params.size() + 1 + results.size());
+  for (size_t i = 0; i < params.size(); ++i) {
+    key.push_back(static_cast<char>(params[i]->kind()));
+  }
+  key.push_back('\xff');  // not a ValKind
+  for (size_t i = 0; i < results.size(); ++i) {
+    key.push_back(static_cast<char>(results[i]->kind()));
+  }
+  return key;
+}
+
+auto StoreImpl::func_type(const FuncType* type) -> const FuncType* {
+  auto& canonical = func_types_[signature(type)];
+  if (!canonical) canonical = type->copy();
+  return canonical.get();
+}
+
+
 auto ExternType::func() -> FuncType* {
   return kind() == ExternKind::FUNC
     ? seal<FuncType>(static_cast<FuncTypeImpl*>(impl(this)))
@@ -726,6 +1211,18 @@ auto GlobalType::mutability() const -> Mutability {
 }
 
 
+auto global_key(ValKind kind, Mutability mutability) -> uint32_t {
+  return static_cast<uint32_t>(kind) << 1 | static_cast<uint32_t>(mutability);
+}
+
+auto StoreImpl::global_type(
+  ValKind kind, Mutability mutability
+) -> const GlobalType* {
+  auto& type = global_types_[global_key(kind, mutability)];
+  if (!type) type = GlobalType::make(ValType::make(kind), mutability);
+  return type.get();
+}
+
 auto ExternType::global() -> GlobalType* {
   return kind() == ExternKind::GLOBAL
     ? seal<GlobalType>(static_cast<GlobalTypeImpl*>(impl(this)))
@@ -1028,57 +1525,67 @@ auto memorytype_to_v8(
 // References
 
 template<class Ref>
-class RefImpl : public v8::Persistent<v8::Object> {
+class RefImpl : public RefHandle {
 public:
   RefImpl() = delete;
   ~RefImpl() = delete;
 
   static auto make(StoreImpl* store, v8::Local<v8::Object> obj) -> own<Ref> {
-    static_assert(sizeof(RefImpl) == sizeof(v8::Persistent<v8::Object>),
+    static_assert(sizeof(RefImpl) == sizeof(RefHandle),
       "incompatible object layout");
     auto self = static_cast<RefImpl*>(store->make_handle());
     if (!self) return nullptr;
     self->Reset(store->isolate(), obj);
-    stats.make(Stats::categorize(*self), self);
+    stats.make(Stats::categorize(obj), self);
+    return make_own(seal<Ref>(self));
+  }
+
+  static auto borrow(StoreImpl* store, v8::Local<v8::Object> obj) -> own<Ref> {
+    auto self = static_cast<RefImpl*>(store->borrow_handle(obj));
+    stats.make(Stats::categorize(obj), self);
     return make_own(seal<Ref>(self));
   }
 
+  auto borrowed() const -> bool {
+    return chunk == nullptr;
+  }
+
+  auto as_borrowed() const -> const BorrowedHandle* {
+    return static_cast<const BorrowedHandle*>(
+      static_cast<const RefHandle*>(this));
+  }
+
   auto copy() const -> own<Ref> {
     v8::HandleScope handle_scope(isolate());
-    return make(store(), v8_object());
+    auto ref = make(store(), v8_object());
+    if (ref) impl(ref.get())->type = type;
+    return ref;
   }
 
   auto store() const -> StoreImpl* {
+    if (borrowed()) return as_borrowed()->store;
     return StoreImpl::get(isolate());
   }
 
   auto isolate() const -> v8::Isolate* {
+    if (borrowed()) return store()->isolate();
     return wasm_v8::object_isolate(*this);
   }
 
   auto v8_object() const -> v8::Local<v8::Object> {
+    if (borrowed()) return as_borrowed()->local;
     return Get(isolate());
   }
 
   auto get_host_info() const -> void* {
     v8::HandleScope handle_scope(isolate());
-    auto store = this->store();
-
-    v8::Local<v8::Value> args[] = { v8_object() };
-    auto maybe_result = store->v8_function(V8_F_WEAKMAP_GET)->Call(
-      store->context(), store->host_data_map(), 1, args);
-    if (maybe_result.IsEmpty()) return nullptr;
-    return wasm_v8::managed_get(maybe_result.ToLocalChecked());
+    auto entry = store()->host_info(v8_object());
+    return entry ? entry->info : nullptr;
   }
 
   void set_host_info(void* info, void (*finalizer)(void*)) {
     v8::HandleScope handle_scope(isolate());
-    auto store = this->store();
-    auto managed = wasm_v8::managed_new(store->isolate(), info, finalizer);
-    v8::Local<v8::Value> args[] = { v8_object(), managed };
-    auto maybe_result = store->v8_function(V8_F_WEAKMAP_SET)->Call(
-      store->context(), store->host_data_map(), 2, args);
-    if (maybe_result.IsEmpty()) return;
+    store()->set_host_info(v8_object(), info, finalizer);
   }
 };
 
@@ -1086,8 +1593,9 @@ template<> struct implement<Ref> { using type = RefImpl<Ref>; };
 
 
 Ref::~Ref() {
-  stats.free(Stats::categorize(*impl(this)), this);
   v8::HandleScope handle_scope(impl(this)->isolate());
+  stats.free(Stats::categorize(impl(this)->v8_object()), this);
+  if (impl(this)->borrowed()) return;
   impl(this)->store()->free_handle(impl(this));
 }
 
@@ -1145,6 +1653,19 @@ auto v8_to_ref(StoreImpl* store, v8::Local<v8::Value> value) -> own<Ref> {
   }
 }
 
+// Borrowed references are released when the current host callback returns.
+auto v8_to_borrowed_ref(
+  StoreImpl* store, v8::Local<v8::Value> value
+) -> own<Ref> {
+  if (value->IsNull()) {
+    return nullptr;
+  } else if (value->IsObject()) {
+    return RefImpl<Ref>::borrow(store, v8::Local<v8::Object>::Cast(value));
+  } else {
+    UNIMPLEMENTED("JS primitive ref value");
+  }
+}
+
 auto v8_to_val(
   StoreImpl* store, v8::Local<v8::Value> value, const ValType* t
 ) -> Val {
@@ -1168,6 +1689,178 @@ auto v8_to_val(
 }
 
 
+// Call Stubs
+
+auto i32_to_v8(StoreImpl* store, const Val& v) -> v8::Local<v8::Value> {
+  return v8::Integer::NewFromUnsigned(store->isolate(), v.i32());
+}
+auto i64_to_v8(StoreImpl* store, const Val& v) -> v8::Local<v8::Value> {
+  return v8::BigInt::New(store->isolate(), v.i64());
+}
+auto f32_to_v8(StoreImpl* store, const Val& v) -> v8::Local<v8::Value> {
+  return v8::Number::New(store->isolate(), v.f32());
+}
+auto f64_to_v8(StoreImpl* store, const Val& v) -> v8::Local<v8::Value> {
+  return v8::Number::New(store->isolate(), v.f64());
+}
+auto ref_val_to_v8(StoreImpl* store, const Val& v) -> v8::Local<v8::Value> {
+  return ref_to_v8(store, v.ref());
+}
+
+void v8_to_i32(StoreImpl* store, v8::Local<v8::Value> value, Val* v) {
+  new (v) Val(value->Int32Value(store->context()).ToChecked());
+}
+void v8_to_i64(StoreImpl* store, v8::Local<v8::Value> value, Val* v) {
+  auto bigint = value->ToBigInt(store->context()).ToLocalChecked();
+  new (v) Val(bigint->Int64Value());
+}
+void v8_to_f32(StoreImpl* store, v8::Local<v8::Value> value, Val* v) {
+  auto number = value->NumberValue(store->context()).ToChecked();
+  new (v) Val(static_cast<float32_t>(number));
+}
+void v8_to_f64(StoreImpl* store, v8::Local<v8::Value> value, Val* v) {
+  new (v) Val(value->NumberValue(store->context()).ToChecked());
+}
+void v8_to_ref_val(StoreImpl* store, v8::Local<v8::Value> value, Val* v) {
+  new (v) Val(v8_to_ref(store, value));
+}
+
+auto param_stub(ValKind kind) -> CallStub::param_t {
+  switch (kind) {
+    case ValKind::I32: return i32_to_v8;
+    case ValKind::I64: return i64_to_v8;
+    case ValKind::F32: return f32_to_v8;
+    case ValKind::F64: return f64_to_v8;
+    case ValKind::ANYREF:
+    case ValKind::FUNCREF: return ref_val_to_v8;
+  }
+}
+
+auto result_stub(ValKind kind) -> CallStub::result_t {
+  switch (kind) {
+    case ValKind::I32: return v8_to_i32;
+    case ValKind::I64: return v8_to_i64;
+    case ValKind::F32: return v8_to_f32;
+    case ValKind::F64: return v8_to_f64;
+    case ValKind::ANYREF:
+    case ValKind::FUNCREF: return v8_to_ref_val;
+  }
+}
+
+template<CallStub::param_t convert>
+void uniform_params(
+  StoreImpl* store, const CallStub* stub,
+  const Val args[], v8::Local<v8::Value> v8_args[]
+) {
+  for (size_t i = 0; i < stub->num_params; ++i) {
+    v8_args[i] = convert(store, args[i]);
+  }
+}
+
+void mixed_params(
+  StoreImpl* store, const CallStub* stub,
+  const Val args[], v8::Local<v8::Value> v8_args[]
+) {
+  for (size_t i = 0; i < stub->num_params; ++i) {
+    v8_args[i] = stub->params[i](store, args[i]);
+  }
+}
+
+// Multiple results are returned as an array.
+template<CallStub::result_t convert>
+void uniform_results(
+  StoreImpl* store, const CallStub* stub,
+  v8::Local<v8::Value> val, Val results[]
+) {
+  if (stub->num_results == 1) return convert(store, val, &results[0]);
+  assert(val->IsArray());
+  auto array = v8::Local<v8::Array>::Cast(val);
+  for (size_t i = 0; i < stub->num_results; ++i) {
+    auto maybe = array->Get(store->context(), i);
+    assert(!maybe.IsEmpty());
+    convert(store, maybe.ToLocalChecked(), &results[i]);
+  }
+}
+
+void mixed_results(
+  StoreImpl* store, const CallStub* stub,
+  v8::Local<v8::Value> val, Val results[]
+) {
+  assert(val->IsArray());
+  auto array = v8::Local<v8::Array>::Cast(val);
+  for (size_t i = 0; i < stub->num_results; ++i) {
+    auto maybe = array->Get(store->context(), i);
+    assert(!maybe.IsEmpty());
+    stub->results[i](store, maybe.ToLocalChecked(), &results[i]);
+  }
+}
+
+// Returns the kind shared by all types, or false if they are mixed.
+auto uniform_kind(const ownvec<ValType>& types, ValKind* kind) -> bool {
+  *kind = types.size() > 0 ? types[0]->kind() : ValKind::I32;
+  for (size_t i = 1; i < types.size(); ++i) {
+    if (types[i]->kind() != *kind) return false;
+  }
+  return true;
+}
+
+auto params_stub(const ownvec<ValType>& types) -> CallStub::params_t {
+  ValKind kind;
+  if (!uniform_kind(types, &kind)) return mixed_params;
+  switch (kind) {
+    case ValKind::I32: return uniform_params<i32_to_v8>;
+    case ValKind::I64: return uniform_params<i64_to_v8>;
+    case ValKind::F32: return uniform_params<f32_to_v8>;
+    case ValKind::F64: return uniform_params<f64_to_v8>;
+    case ValKind::ANYREF:
+    case ValKind::FUNCREF: return uniform_params<ref_val_to_v8>;
+  }
+}
+
+auto results_stub(const ownvec<ValType>& types) -> CallStub::results_t {
+  ValKind kind;
+  if (!uniform_kind(types, &kind)) return mixed_results;
+  switch (kind) {
+    case ValKind::I32: return uniform_results<v8_to_i32>;
+    case ValKind::I64: return uniform_results<v8_to_i64>;
+    case ValKind::F32: return uniform_results<v8_to_f32>;
+    case ValKind::F64: return uniform_results<v8_to_f64>;
+    case ValKind::ANYREF:
+    case ValKind::FUNCREF: return uniform_results<v8_to_ref_val>;
+  }
+}
+
+auto StoreImpl::call_stub(const FuncType* type) -> const CallStub* {
+  auto& stub = call_stubs_[type];
+  if (stub) {
+    ++counters_.call_stub_hits;
+    return stub.get();
+  }
+  ++counters_.call_stub_misses;
+  stub.reset(new(std::nothrow) CallStub());
+  if (!stub) return nullptr;
+  auto& params = type->params();
+  auto& results = type->results();
+  stub->num_params = params.size();
+  stub->num_results = results.size();
+  stub->convert_params = params_stub(params);
+  stub->convert_results = results_stub(results);
+  if (stub->convert_params == mixed_params) {
+    stub->params.resize(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+      stub->params[i] = param_stub(params[i]->kind());
+    }
+  }
+  if (stub->convert_results == mixed_results) {
+    stub->results.resize(results.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+      stub->results[i] = result_stub(results[i]->kind());
+    }
+  }
+  return stub.get();
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Runtime Objects
 
@@ -1300,6 +1993,119 @@ template<> struct implement<Module> { using type = RefImpl<Module>; };
 
 Module::~Module() {}
 
+// Immutable metadata decoded from a module's binary. It is shared by all
+// handles to the module, including those obtained in other stores.
+struct ModuleData {
+  ownvec<ImportType> imports;
+  ownvec<ExportType> exports;
+  std::unordered_map<std::string, size_t> export_indices;
+  // Distinct import module names, and the index of each import's module.
+  std::vector<std::string> import_modules;
+  std::vector<size_t> import_module_indices;
+
+  explicit ModuleData(const vec<byte_t>& binary) :
+    imports(wasm::bin::imports(binary)), exports(wasm::bin::exports(binary))
+  {
+    std::unordered_map<std::string, size_t> module_indices;
+    for (size_t i = 0; i < imports.size(); ++i) {
+      auto& module = imports[i]->module();
+      auto name = std::string(module.get(), module.size());
+      auto result = module_indices.emplace(name, import_modules.size());
+      if (result.second) import_modules.push_back(name);
+      import_module_indices.push_back(result.first->second);
+    }
+    for (size_t i = 0; i < exports.size(); ++i) {
+      auto& name = exports[i]->name();
+      export_indices.emplace(std::string(name.get(), name.size()), i);
+    }
+  }
+};
+
+namespace {
+
+void delete_module_data(void* data) {
+  delete static_cast<std::shared_ptr<ModuleData>*>(data);
+}
+
+void set_module_data(
+  StoreImpl* store, v8::Local<v8::Object> module,
+  const std::shared_ptr<ModuleData>& data
+) {
+  auto managed = wasm_v8::managed_new(store->isolate(),
+    new std::shared_ptr<ModuleData>(data), &delete_module_data);
+  ignore(module->SetPrivate(
+    store->context(), store->v8_private(V8_P_MODULE_DATA), managed));
+}
+
+auto get_module_data(
+  StoreImpl* store, v8::Local<v8::Object> module
+) -> std::shared_ptr<ModuleData>* {
+  auto maybe = module->GetPrivate(
+    store->context(), store->v8_private(V8_P_MODULE_DATA));
+  if (maybe.IsEmpty()) return nullptr;
+  auto value = maybe.ToLocalChecked();
+  if (value->IsUndefined()) return nullptr;
+  return static_cast<std::shared_ptr<ModuleData>*>(
+    wasm_v8::managed_get(value));
+}
+
+// Returns the module's metadata, decoding it on first use.
+auto module_data(
+  StoreImpl* store, v8::Local<v8::Object> module
+) -> const std::shared_ptr<ModuleData>& {
+  auto data = get_module_data(store, module);
+  if (data == nullptr) {
+    auto binary = vec<byte_t>::adopt(
+      wasm_v8::module_binary_size(module),
+      const_cast<byte_t*>(wasm_v8::module_binary(module))
+    );
+    set_module_data(store, module, std::make_shared<ModuleData>(binary));
+    binary.release();
+    data = get_module_data(store, module);
+  }
+  return *data;
+}
+
+auto v8_name(
+  StoreImpl* store, const char* name, size_t size
+) -> v8::MaybeLocal<v8::String> {
+  return v8::String::NewFromUtf8(store->isolate(), name,
+    v8::NewStringType::kInternalized, size);
+}
+
+// Returns the names needed to build the module's imports object, created
+// once per store: the distinct module names followed by each import's name.
+auto import_plan(
+  StoreImpl* store, v8::Local<v8::Object> module, const ModuleData* data
+) -> v8::MaybeLocal<v8::Array> {
+  auto context = store->context();
+  auto key = store->v8_private(V8_P_IMPORT_PLAN);
+  auto maybe = module->GetPrivate(context, key);
+  if (maybe.IsEmpty()) return v8::MaybeLocal<v8::Array>();
+  auto value = maybe.ToLocalChecked();
+  if (value->IsArray()) return v8::Local<v8::Array>::Cast(value);
+
+  auto num_modules = data->import_modules.size();
+  auto plan = v8::Array::New(
+    store->isolate(), num_modules + data->imports.size());
+  for (size_t i = 0; i < num_modules; ++i) {
+    auto& name = data->import_modules[i];
+    auto maybe_name = v8_name(store, name.data(), name.size());
+    if (maybe_name.IsEmpty()) return v8::MaybeLocal<v8::Array>();
+    ignore(plan->Set(context, i, maybe_name.ToLocalChecked()));
+  }
+  for (size_t i = 0; i < data->imports.size(); ++i) {
+    auto& name = data->imports[i]->name();
+    auto maybe_name = v8_name(store, name.get(), name.size());
+    if (maybe_name.IsEmpty()) return v8::MaybeLocal<v8::Array>();
+    ignore(plan->Set(context, num_modules + i, maybe_name.ToLocalChecked()));
+  }
+  ignore(module->SetPrivate(context, key, plan));
+  return plan;
+}
+
+}  // namespace
+
 auto Module::copy() const -> own<Module> {
   return impl(this)->copy();
 }
@@ -1320,105 +2126,447 @@ auto Module::validate(Store* store_abs, const vec<byte_t>& binary) -> bool {
   return result.ToLocalChecked()->IsTrue();
 }
 
-auto Module::make(Store* store_abs, const vec<byte_t>& binary) -> own<Module> {
-  auto store = impl(store_abs);
-  auto isolate = store->isolate();
-  auto context = store->context();
-  v8::HandleScope handle_scope(isolate);
+namespace {
 
-  auto array_buffer = v8::ArrayBuffer::New(
-    isolate, const_cast<byte_t*>(binary.get()), binary.size());
+// Files mapped read-only into memory, for as long as the object lives.
+// Without POSIX, they are read into a buffer instead.
+struct MappedFile {
+  const byte_t* data = nullptr;
+  size_t size = 0;
+
+#ifdef WASM_V8_POSIX
+  explicit MappedFile(const char* path) {
+    auto fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      auto addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        data = static_cast<const byte_t*>(addr);
+        size = st.st_size;
+      }
+    }
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data) munmap(const_cast<byte_t*>(data), size);
+  }
+#else
+  vec<byte_t> buffer = vec<byte_t>::make();
+
+  explicit MappedFile(const char* path) {
+    auto file = std::fopen(path, "rb");
+    if (!file) return;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+      auto end = std::ftell(file);
+      if (end > 0 && std::fseek(file, 0, SEEK_SET) == 0) {
+        buffer = vec<byte_t>::make_uninitialized(end);
+        if (buffer && std::fread(buffer.get(), 1, end, file) ==
+              static_cast<size_t>(end)) {
+          data = buffer.get();
+          size = end;
+        }
+      }
+    }
+    std::fclose(file);
+  }
+#endif
 
-  v8::Local<v8::Value> args[] = {array_buffer};
-  auto maybe_obj =
-    store->v8_function(V8_F_MODULE)->NewInstance(context, 1, args);
-  if (maybe_obj.IsEmpty()) return nullptr;
-  return RefImpl<Module>::make(store, maybe_obj.ToLocalChecked());
-}
+  MappedFile(const MappedFile&) = delete;
+  auto operator=(const MappedFile&) -> MappedFile& = delete;
+};
 
-auto Module::imports() const -> ownvec<ImportType> {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  auto module = impl(this)->v8_object();
-  auto binary = vec<byte_t>::adopt(
-    wasm_v8::module_binary_size(module),
-    const_cast<byte_t*>(wasm_v8::module_binary(module))
-  );
-  auto imports = wasm::bin::imports(binary);
-  binary.release();
-  return imports;
-  // return impl(this)->data->imports.copy();
-/* OBSOLETE?
-  auto store = module->store();
-  auto isolate = store->isolate();
-  auto context = store->context();
-  v8::HandleScope handle_scope(isolate);
+// Serialized modules start with a fixed header identifying the format, the
+// engine build and flags, and the CPU features the code was compiled for,
+// so that incompatible artifacts are rejected before deserializing. It is
+// followed by the payload: u64(binary size) | binary | V8 data.
+struct SerialHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t engine;
+  uint64_t cpu;
+  uint64_t size;  // of the payload
+  uint64_t checksum;  // of the payload
+};
 
-  v8::Local<v8::Value> args[] = { module->v8_object() };
-  auto result = store->v8_function(V8_F_IMPORTS)->Call(
-    context, v8::Undefined(isolate), 1, args);
-  if (result.IsEmpty()) return wasm_importtype_vec_empty();
-  auto array = v8::Local<v8::Array>::Cast(result.ToLocalChecked());
-  size_t size = array->Length();
+const char serial_magic[8] = {'\0', 'w', 'a', 's', 'm', 'b', 'i', 'n'};
+const uint32_t serial_version = 1;
 
-  wasm_importtype_vec_t imports = wasm_importtype_vec_new_uninitialized(size);
+auto fnv1a(uint64_t hash, const byte_t* data, size_t size) -> uint64_t {
   for (size_t i = 0; i < size; ++i) {
-    auto desc = v8::Local<v8::Object>::Cast(array->Get(i));
-    auto module_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_MODULE)).ToLocalChecked());
-    auto name_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_NAME)).ToLocalChecked());
-    auto kind_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_KIND)).ToLocalChecked());
-
-    auto type = wasm_externtype_new_from_v8_kind(store, kind_str);
-    auto module = wasm_byte_vec_new_from_v8_string(module_str);
-    auto name = wasm_byte_vec_new_from_v8_string(name_str);
-    imports.data[i] = wasm_importtype_new(module, name, type);
-  }
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * 0x100000001b3;
+  }
+  return hash;
+}
+
+// Processes a word at a time, since payloads can be large.
+auto serial_checksum(const byte_t* data, size_t size) -> uint64_t {
+  uint64_t hash = 0xcbf29ce484222325;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * 0x100000001b3;
+    hash ^= hash >> 29;
+  }
+  return fnv1a(hash, data + i, size - i);
+}
+
+// The V8 version and the flags affecting generated code. Flags are fixed
+// once the engine is made, so this is computed once.
+auto serial_engine() -> uint64_t {
+  static const uint64_t engine = [] {
+    auto version = v8::V8::GetVersion();
+    auto hash = fnv1a(0xcbf29ce484222325, version, std::strlen(version));
+    bool flags[] = {
+      v8::internal::FLAG_experimental_wasm_bigint,
+      v8::internal::FLAG_experimental_wasm_mv,
+      v8::internal::FLAG_experimental_wasm_anyref,
+      v8::internal::FLAG_experimental_wasm_bulk_memory,
+      v8::internal::FLAG_experimental_wasm_return_call,
+      v8::internal::FLAG_liftoff,
+      v8::internal::FLAG_wasm_tier_up,
+      v8::internal::FLAG_wasm_lazy_compilation,
+    };
+    for (auto flag : flags) hash = (hash ^ flag) * 0x100000001b3;
+    return hash;
+  }();
+  return engine;
+}
+
+// The architecture in the top byte, and its relevant features below.
+auto serial_cpu() -> uint64_t {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  static const uint64_t cpu = [] {
+    __builtin_cpu_init();
+    bool features[] = {
+      __builtin_cpu_supports("sse3") != 0,
+      __builtin_cpu_supports("ssse3") != 0,
+      __builtin_cpu_supports("sse4.1") != 0,
+      __builtin_cpu_supports("sse4.2") != 0,
+      __builtin_cpu_supports("popcnt") != 0,
+      __builtin_cpu_supports("avx") != 0,
+      __builtin_cpu_supports("avx2") != 0,
+      __builtin_cpu_supports("bmi") != 0,
+      __builtin_cpu_supports("bmi2") != 0,
+    };
+    uint64_t bits = uint64_t{sizeof(void*) == 8 ? 1u : 2u} << 56;
+    for (size_t i = 0; i < sizeof(features) / sizeof(features[0]); ++i) {
+      if (features[i]) bits |= uint64_t{1} << i;
+    }
+    return bits;
+  }();
+  return cpu;
+#elif defined(__aarch64__)
+  return uint64_t{3} << 56;
+#elif defined(__arm__)
+  return uint64_t{4} << 56;
+#else
+  return 0;
+#endif
+}
 
-  return imports;
-*/
+// Checks the header in constant time, returning the payload, or null if
+// the data is not a compatible serialized module.
+auto serial_payload(const byte_t* data, size_t size) -> const byte_t* {
+  SerialHeader header;
+  if (size < sizeof(header)) return nullptr;
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, serial_magic, sizeof(serial_magic)) != 0 ||
+      header.version != serial_version ||
+      header.size != size - sizeof(header) ||
+      header.engine != serial_engine() || header.cpu != serial_cpu()) {
+    return nullptr;
+  }
+  return data + sizeof(header);
 }
 
-auto Module::exports() const -> ownvec<ExportType> {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  auto module = impl(this)->v8_object();
-  auto binary = vec<byte_t>::adopt(
-    wasm_v8::module_binary_size(module),
-    const_cast<byte_t*>(wasm_v8::module_binary(module))
-  );
-  auto exports = wasm::bin::exports(binary);
-  binary.release();
-  return exports;
-  // return impl(this)->data->exports.copy();
-/* OBSOLETE?
-  auto store = module->store();
+// Deserializes the output of Module::serialize, in place, once
+// serial_payload has accepted its header.
+auto deserialize_module(
+  StoreImpl* store, const byte_t* serialized, size_t size
+) -> own<Module> {
+  auto payload = serialized + sizeof(SerialHeader);
+  size -= sizeof(SerialHeader);
+  SerialHeader header;
+  std::memcpy(&header, serialized, sizeof(header));
+  if (size == 0 || header.checksum != serial_checksum(payload, size)) {
+    return nullptr;
+  }
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+  auto ptr = payload;
+  uint64_t binary_size;
+  if (!wasm::bin::u64(ptr, payload + size, &binary_size)) return nullptr;
+  auto size_size = static_cast<size_t>(ptr - payload);
+  if (binary_size > size - size_size) return nullptr;
+  auto serial_size = size - size_size - binary_size;
+  auto maybe_obj = wasm_v8::module_deserialize(
+    isolate, ptr, binary_size, ptr + binary_size, serial_size);
+  if (maybe_obj.IsEmpty()) return nullptr;
+  return RefImpl<Module>::make(store, maybe_obj.ToLocalChecked());
+}
+
+}  // namespace
+
+
+// Code Cache
+
+// Compiled modules are cached in files named by a hash of their binary,
+// each holding the serialized module. Its header rejects entries from other
+// engine builds or configurations, and its payload starts with the binary
+// itself, against which lookups are compared, to rule out hash collisions.
+// The cache is only available on POSIX hosts.
+
+namespace {
+
+auto elapsed_ns(std::chrono::steady_clock::time_point start) -> uint64_t {
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    end - start).count();
+}
+
+#ifdef WASM_V8_POSIX
+const char* const cache_suffix = ".wasmcache";
+
+auto cache_path(const ConfigImpl* config, const vec<byte_t>& binary)
+-> std::string {
+  auto hash = fnv1a(0xcbf29ce484222325, binary.get(), binary.size());
+  char name[17];
+  std::snprintf(name, sizeof(name), "%016llx",
+    static_cast<unsigned long long>(hash));
+  return config->cache_directory + "/" + name + cache_suffix;
+}
+
+auto cache_load(StoreImpl* store, const vec<byte_t>& binary) -> own<Module> {
+  auto config = impl(store->engine()->config.get());
+  auto path = cache_path(config, binary);
+  MappedFile file(path.c_str());
+  if (!file.data) return nullptr;
+
+  char size[16];
+  auto size_end = size;
+  wasm::bin::encode_u64(size_end, binary.size());
+  auto size_size = static_cast<size_t>(size_end - size);
+  auto ptr = serial_payload(file.data, file.size);
+  if (!ptr ||
+      file.size < sizeof(SerialHeader) + size_size + binary.size() ||
+      std::memcmp(ptr, size, size_size) != 0 ||
+      std::memcmp(ptr + size_size, binary.get(), binary.size()) != 0) {
+    return nullptr;
+  }
+
+  auto module = deserialize_module(store, file.data, file.size);
+  // Recently used entries are evicted last.
+  if (module) utime(path.c_str(), nullptr);
+  return module;
+}
+
+// Removes the least recently used entries until the cache fits its limit.
+void cache_evict(StoreImpl* store) {
+  auto config = impl(store->engine()->config.get());
+  auto dir = opendir(config->cache_directory.c_str());
+  if (!dir) return;
+  struct Entry {
+    std::string path;
+    size_t size;
+    time_t time;
+  };
+  std::vector<Entry> entries;
+  size_t total = 0;
+  auto suffix_size = std::strlen(cache_suffix);
+  while (auto entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() <= suffix_size ||
+        name.compare(name.size() - suffix_size, suffix_size, cache_suffix)) {
+      continue;
+    }
+    auto path = config->cache_directory + "/" + name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) continue;
+    entries.push_back({path, static_cast<size_t>(st.st_size), st.st_mtime});
+    total += st.st_size;
+  }
+  closedir(dir);
+
+  if (total <= config->cache_size_limit) return;
+  std::sort(entries.begin(), entries.end(),
+    [](const Entry& a, const Entry& b) { return a.time < b.time; });
+  for (auto& entry : entries) {
+    if (total <= config->cache_size_limit) break;
+    if (unlink(entry.path.c_str()) == 0) {
+      total -= entry.size;
+      ++store->counters().cache_evictions;
+    }
+  }
+}
+
+// Writes to a temporary file first, so that readers never see a partial
+// entry.
+void cache_store(
+  StoreImpl* store, const vec<byte_t>& binary, const Module* module
+) {
+  auto serialized = module->serialize();
+  if (!serialized) return;
+  auto config = impl(store->engine()->config.get());
+  auto path = cache_path(config, binary);
+  auto temp_path = path + "." + std::to_string(getpid()) + "." +
+    std::to_string(reinterpret_cast<uintptr_t>(store)) + ".tmp";
+  auto file = std::fopen(temp_path.c_str(), "wb");
+  if (!file) return;
+  auto written = std::fwrite(serialized.get(), 1, serialized.size(), file) ==
+    serialized.size();
+  if (std::fclose(file) != 0 || !written ||
+      std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+    return;
+  }
+  if (config->cache_size_limit > 0) cache_evict(store);
+}
+#endif
+
+// Compiles without the code cache, which internal wrapper modules bypass so
+// that they do not take up the user's cache.
+auto compile(StoreImpl* store, const vec<byte_t>& binary) -> own<Module> {
   auto isolate = store->isolate();
   auto context = store->context();
   v8::HandleScope handle_scope(isolate);
 
-  v8::Local<v8::Value> args[] = { module->v8_object() };
-  auto result = store->v8_function(V8_F_EXPORTS)->Call(
-    context, v8::Undefined(isolate), 1, args);
-  if (result.IsEmpty()) return wasm_exporttype_vec_empty();
-  auto array = v8::Local<v8::Array>::Cast(result.ToLocalChecked());
-  size_t size = array->Length();
+  auto array_buffer = v8::ArrayBuffer::New(
+    isolate, const_cast<byte_t*>(binary.get()), binary.size());
 
-  wasm_exporttype_vec_t exports = wasm_exporttype_vec_new_uninitialized(size);
-  for (size_t i = 0; i < size; ++i) {
-    auto desc = v8::Local<v8::Object>::Cast(array->Get(i));
-    auto name_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_NAME)).ToLocalChecked());
-    auto kind_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_KIND)).ToLocalChecked());
+  v8::Local<v8::Value> args[] = {array_buffer};
+  auto maybe_obj =
+    store->v8_function(V8_F_MODULE)->NewInstance(context, 1, args);
+  if (maybe_obj.IsEmpty()) return nullptr;
+  return RefImpl<Module>::make(store, maybe_obj.ToLocalChecked());
+}
 
-    auto type = wasm_externtype_new_from_v8_kind(store, kind_str);
-    auto name = wasm_byte_vec_new_from_v8_string(name_str);
-    exports.data[i] = wasm_exporttype_new(name, type);
+#ifdef WASM_V8_POSIX
+auto cache_compile(StoreImpl* store, const vec<byte_t>& binary)
+-> own<Module> {
+  auto& counters = store->counters();
+  auto start = std::chrono::steady_clock::now();
+  auto module = cache_load(store, binary);
+  if (module) {
+    ++counters.cache_hits;
+    counters.cache_load_ns += elapsed_ns(start);
+    return module;
   }
+  ++counters.cache_misses;
+  module = compile(store, binary);
+  if (module) cache_store(store, binary, module.get());
+  counters.cache_compile_ns += elapsed_ns(start);
+  return module;
+}
+#endif
 
-  return exports;
-*/
+}  // namespace
+
+auto Module::make(Store* store_abs, const vec<byte_t>& binary) -> own<Module> {
+  auto store = impl(store_abs);
+#ifdef WASM_V8_POSIX
+  auto config = impl(store->engine()->config.get());
+  if (!config->cache_directory.empty()) return cache_compile(store, binary);
+#endif
+  return compile(store, binary);
+}
+
+namespace {
+
+// Completes a compilation started by Module::compile_async, from a promise
+// reaction run by Store::pump.
+template<bool fulfilled>
+void compile_completed(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  auto job = static_cast<CompileJob*>(
+    v8::Local<v8::External>::Cast(info.Data())->Value());
+  auto store = StoreImpl::get(info.GetIsolate());
+  v8::HandleScope handle_scope(store->isolate());
+  own<Module> module;
+  if (fulfilled && info[0]->IsObject()) {
+    module = RefImpl<Module>::make(
+      store, v8::Local<v8::Object>::Cast(info[0]));
+  }
+  store->finish_compile(job);
+  job->callback(job->env, std::move(module));
+  delete job;
+}
+
+}  // namespace
+
+void Module::compile_async(
+  Store* store_abs, const vec<byte_t>& binary,
+  compile_callback callback, void* env
+) {
+  auto store = impl(store_abs);
+  auto isolate = store->isolate();
+  auto context = store->context();
+  v8::HandleScope handle_scope(isolate);
+
+  auto job = new(std::nothrow) CompileJob{callback, env};
+  if (!job) {
+    callback(env, nullptr);
+    return;
+  }
+
+  // Compilation outlives the call, so it gets its own copy of the binary.
+  auto array_buffer = v8::ArrayBuffer::New(isolate, binary.size());
+  if (binary.size() > 0) {
+    std::memcpy(array_buffer->GetContents().Data(),
+      binary.get(), binary.size());
+  }
+
+  v8::Local<v8::Value> args[] = {array_buffer};
+  auto maybe_promise = store->v8_function(V8_F_COMPILE)->Call(
+    context, v8::Undefined(isolate), 1, args);
+  auto data = v8::External::New(isolate, job);
+  auto maybe_fulfilled =
+    v8::Function::New(context, &compile_completed<true>, data);
+  auto maybe_rejected =
+    v8::Function::New(context, &compile_completed<false>, data);
+  if (maybe_promise.IsEmpty() || maybe_fulfilled.IsEmpty() ||
+      maybe_rejected.IsEmpty()) {
+    delete job;
+    callback(env, nullptr);
+    return;
+  }
+  auto promise =
+    v8::Local<v8::Promise>::Cast(maybe_promise.ToLocalChecked());
+  if (promise->Then(context, maybe_fulfilled.ToLocalChecked(),
+        maybe_rejected.ToLocalChecked()).IsEmpty()) {
+    delete job;
+    callback(env, nullptr);
+    return;
+  }
+  store->start_compile(job);
+}
+
+auto Module::imports() const -> ownvec<ImportType> {
+  auto module = impl(this);
+  v8::HandleScope handle_scope(module->isolate());
+  return module_data(module->store(), module->v8_object())->imports.deep_copy();
+}
+
+auto Module::exports() const -> ownvec<ExportType> {
+  auto module = impl(this);
+  v8::HandleScope handle_scope(module->isolate());
+  return module_data(module->store(), module->v8_object())->exports.deep_copy();
+}
+
+auto Module::func_tiers() const -> vec<FuncTier> {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto module = impl(this)->v8_object();
+  auto size = wasm_v8::module_func_count(module);
+  std::vector<wasm_v8::func_tier_t> v8_tiers(size);
+  wasm_v8::module_func_tiers(module, v8_tiers.data());
+  auto tiers = vec<FuncTier>::make_uninitialized(size);
+  if (!tiers) return tiers;
+  for (size_t i = 0; i < size; ++i) {
+    tiers[i] = static_cast<FuncTier>(v8_tiers[i]);
+  }
+  return tiers;
 }
 
 auto Module::serialize() const -> vec<byte_t> {
@@ -1427,38 +2575,56 @@ auto Module::serialize() const -> vec<byte_t> {
   auto binary_size = wasm_v8::module_binary_size(module);
   auto serial_size = wasm_v8::module_serialize_size(module);
   auto size_size = wasm::bin::u64_size(binary_size);
+  auto payload_size = size_size + binary_size + serial_size;
   auto buffer = vec<byte_t>::make_uninitialized(
-    size_size + binary_size + serial_size);
-  auto ptr = buffer.get();
+    sizeof(SerialHeader) + payload_size);
+  if (!buffer) return buffer;
+  auto payload = buffer.get() + sizeof(SerialHeader);
+  auto ptr = payload;
   wasm::bin::encode_u64(ptr, binary_size);
   std::memcpy(ptr, wasm_v8::module_binary(module), binary_size);
   ptr += binary_size;
-  if (!wasm_v8::module_serialize(module, ptr, serial_size)) buffer.reset();
+  if (!wasm_v8::module_serialize(module, ptr, serial_size)) {
+    buffer.reset();
+    return buffer;
+  }
+  SerialHeader header = {};
+  std::memcpy(header.magic, serial_magic, sizeof(serial_magic));
+  header.version = serial_version;
+  header.engine = serial_engine();
+  header.cpu = serial_cpu();
+  header.size = payload_size;
+  header.checksum = serial_checksum(payload, payload_size);
+  std::memcpy(buffer.get(), &header, sizeof(header));
   return buffer;
 }
 
 auto Module::deserialize(Store* store_abs, const vec<byte_t>& serialized) -> own<Module> {
-  auto store = impl(store_abs);
-  auto isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
-  auto ptr = serialized.get();
-  auto binary_size = wasm::bin::u64(ptr);
-  auto size_size = ptr - serialized.get();
-  auto serial_size = serialized.size() - size_size - binary_size;
-  auto maybe_obj = wasm_v8::module_deserialize(
-    isolate, ptr, binary_size, ptr + binary_size, serial_size);
-  if (maybe_obj.IsEmpty()) return nullptr;
-  return RefImpl<Module>::make(store, maybe_obj.ToLocalChecked());
+  if (!serial_payload(serialized.get(), serialized.size())) return nullptr;
+  return deserialize_module(
+    impl(store_abs), serialized.get(), serialized.size());
 }
 
+auto Module::deserialize_mapped(Store* store_abs, const char* path) -> own<Module> {
+  MappedFile file(path);
+  if (!file.data || !serial_payload(file.data, file.size)) return nullptr;
+  return deserialize_module(impl(store_abs), file.data, file.size);
+}
 
-// TODO(v8): do better when V8 can do better.
-template<> struct implement<Shared<Module>> { using type = vec<byte_t>; };
+
+// Shares V8's native module, so that its code is compiled once per process
+// and obtaining it in another store does not copy or recompile anything.
+struct SharedModuleImpl {
+  v8::WasmModuleObject::TransferrableModule module;
+  std::shared_ptr<ModuleData> data;
+};
+
+template<> struct implement<Shared<Module>> { using type = SharedModuleImpl; };
 
 template<>
 Shared<Module>::~Shared() {
   stats.free(Stats::MODULE, this, Stats::SHARED);
-  impl(this)->~vec();
+  impl(this)->~SharedModuleImpl();
 }
 
 template<>
@@ -1467,16 +2633,157 @@ void Shared<Module>::operator delete(void* p) {
 }
 
 auto Module::share() const -> own<Shared<Module>> {
-  auto shared = seal<Shared<Module>>(new vec<byte_t>(serialize()));
+  auto module = impl(this);
+  v8::HandleScope handle_scope(module->isolate());
+  auto data = module_data(module->store(), module->v8_object());
+  auto v8_module =
+    v8::Local<v8::WasmModuleObject>::Cast(module->v8_object());
+  auto shared = seal<Shared<Module>>(new(std::nothrow) SharedModuleImpl{
+    v8_module->GetTransferrableModule(), data});
+  if (!shared) return nullptr;
   stats.make(Stats::MODULE, shared, Stats::SHARED);
   return make_own(shared);
 }
 
-auto Module::obtain(Store* store, const Shared<Module>* shared) -> own<Module> {
-  return Module::deserialize(store, *impl(shared));
+auto Module::obtain(Store* store_abs, const Shared<Module>* shared) -> own<Module> {
+  auto store = impl(store_abs);
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+  auto maybe_obj = v8::WasmModuleObject::FromTransferrableModule(
+    isolate, impl(shared)->module);
+  if (maybe_obj.IsEmpty()) return nullptr;
+  auto obj = maybe_obj.ToLocalChecked();
+  set_module_data(store, obj, impl(shared)->data);
+  return RefImpl<Module>::make(store, obj);
+}
+
+
+// Streaming Compilation
+
+struct ModuleStreamImpl {
+  StoreImpl* store;
+  std::shared_ptr<v8::WasmStreaming> streaming;
+  CompileJob* job = nullptr;
+  bool done = false;
+  own<Module> module;
+
+  ModuleStreamImpl(StoreImpl* store) : store(store) {
+    stats.make(Stats::MODULESTREAM, this);
+  }
+
+  ~ModuleStreamImpl() {
+    abandon();
+    stats.free(Stats::MODULESTREAM, this);
+  }
+
+  // Unregisters a pending compilation, detaching its completion from the
+  // stream.
+  void abandon() {
+    if (done || !job) return;
+    store->finish_compile(job);
+    job->callback = &discard;
+    job = nullptr;
+    if (streaming) {
+      v8::HandleScope handle_scope(store->isolate());
+      streaming->Abort(v8::Exception::Error(store->v8_string(V8_S_EMPTY)));
+    }
+  }
+
+  auto pump(bool wait) -> bool {
+    return seal<Store>(store)->pump(wait);
+  }
+
+  static void compiled(void* env, own<Module>&& module) {
+    auto self = static_cast<ModuleStreamImpl*>(env);
+    self->module = std::move(module);
+    self->done = true;
+  }
+
+  static void discard(void*, own<Module>&&) {}
+};
+
+template<> struct implement<ModuleStream> { using type = ModuleStreamImpl; };
+
+
+// Called from a microtask started by compileStreaming, whose source is the
+// stream object, to hand over V8's streaming decoder.
+void streaming_callback(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  if (!info[0]->IsExternal()) return;
+  auto stream = static_cast<ModuleStreamImpl*>(
+    v8::Local<v8::External>::Cast(info[0])->Value());
+  stream->streaming =
+    v8::WasmStreaming::Unpack(info.GetIsolate(), info.Data());
+}
+
+
+ModuleStream::~ModuleStream() {
+  impl(this)->~ModuleStreamImpl();
 }
 
+void ModuleStream::operator delete(void *p) {
+  ::operator delete(p);
+}
+
+auto ModuleStream::make(Store* store_abs) -> own<ModuleStream> {
+  auto store = impl(store_abs);
+  auto isolate = store->isolate();
+  auto context = store->context();
+  v8::HandleScope handle_scope(isolate);
 
+  auto stream = make_own(new(std::nothrow) ModuleStreamImpl(store));
+  if (!stream) return own<ModuleStream>();
+  auto job = new(std::nothrow) CompileJob{
+    &ModuleStreamImpl::compiled, stream.get()};
+  if (!job) return own<ModuleStream>();
+
+  v8::Local<v8::Value> args[] = {v8::External::New(isolate, stream.get())};
+  auto maybe_promise = store->v8_function(V8_F_COMPILE_STREAMING)->Call(
+    context, v8::Undefined(isolate), 1, args);
+  auto data = v8::External::New(isolate, job);
+  auto maybe_fulfilled =
+    v8::Function::New(context, &compile_completed<true>, data);
+  auto maybe_rejected =
+    v8::Function::New(context, &compile_completed<false>, data);
+  if (maybe_promise.IsEmpty() || maybe_fulfilled.IsEmpty() ||
+      maybe_rejected.IsEmpty()) {
+    delete job;
+    return own<ModuleStream>();
+  }
+  auto promise =
+    v8::Local<v8::Promise>::Cast(maybe_promise.ToLocalChecked());
+  if (promise->Then(context, maybe_fulfilled.ToLocalChecked(),
+        maybe_rejected.ToLocalChecked()).IsEmpty()) {
+    delete job;
+    return own<ModuleStream>();
+  }
+  store->start_compile(job);
+  stream->job = job;
+
+  // Runs the streaming callback.
+  isolate->RunMicrotasks();
+  if (!stream->streaming) {
+    stream->abandon();
+    return own<ModuleStream>();
+  }
+  return make_own(seal<ModuleStream>(stream.release()));
+}
+
+auto ModuleStream::push(const byte_t* data, size_t size) -> bool {
+  auto stream = impl(this);
+  if (stream->done) return false;
+  stream->streaming->OnBytesReceived(
+    reinterpret_cast<const uint8_t*>(data), size);
+  return true;
+}
+
+auto ModuleStream::finish() -> own<Module> {
+  auto stream = impl(this);
+  if (!stream->done) {
+    stream->streaming->Finish();
+    while (!stream->done && stream->pump(true)) {}
+  }
+  return std::move(stream->module);
+}
 
 
 // Externals
@@ -1555,10 +2862,11 @@ auto Func::copy() const -> own<Func> {
 struct FuncData {
   Store* store;
   own<FuncType> type;
-  enum Kind { CALLBACK, CALLBACK_WITH_ENV } kind;
+  enum Kind { CALLBACK, CALLBACK_WITH_ENV, CALLBACK_RAW } kind;
   union {
     Func::callback callback;
     Func::callback_with_env callback_with_env;
+    Func::callback_raw callback_raw;
   };
   void (*finalizer)(void*);
   void* env;
@@ -1586,8 +2894,43 @@ struct FuncData {
   static void finalize_func_data(void* data);
 };
 
+auto StoreImpl::func_wrapper(const FuncType* type) -> const Module* {
+  auto& module = func_wrappers_[func_type(type)];
+  if (module) {
+    ++counters_.func_wrapper_hits;
+    return module.get();
+  }
+  ++counters_.func_wrapper_misses;
+  auto binary = wasm::bin::wrapper(type);
+  module = compile(this, binary);
+  return module.get();
+}
+
 namespace {
 
+// Creates the V8 function invoking a host callback.
+auto make_host_function(
+  StoreImpl* store, FuncData* data
+) -> v8::MaybeLocal<v8::Function> {
+  auto isolate = store->isolate();
+  auto v8_data = wasm_v8::foreign_new(isolate, data);
+  auto function_template = v8::FunctionTemplate::New(
+    isolate, &FuncData::v8_callback, v8_data);
+  return function_template->GetFunction(store->context());
+}
+
+// Wraps an export of a wrapper instance, which takes ownership of the data.
+auto make_wrapped_func(
+  StoreImpl* store, FuncData* data, v8::Local<v8::Value> obj
+) -> own<Func> {
+  assert(!obj.IsEmpty());
+  assert(obj->IsFunction());
+  auto func = RefImpl<Func>::make(store, v8::Local<v8::Object>::Cast(obj));
+  impl(func.get())->type = store->func_type(data->type.get());
+  func->set_host_info(data, &FuncData::finalize_func_data);
+  return func;
+}
+
 auto make_func(Store* store_abs, FuncData* data) -> own<Func> {
   auto store = impl(store_abs);
   auto isolate = store->isolate();
@@ -1595,16 +2938,13 @@ auto make_func(Store* store_abs, FuncData* data) -> own<Func> {
   auto context = store->context();
 
   // Create V8 function
-  auto v8_data = wasm_v8::foreign_new(isolate, data);
-  auto function_template = v8::FunctionTemplate::New(
-    isolate, &FuncData::v8_callback, v8_data);
-  auto maybe_func_obj = function_template->GetFunction(context);
+  auto maybe_func_obj = make_host_function(store, data);
   if (maybe_func_obj.IsEmpty()) return own<Func>();
   auto func_obj = maybe_func_obj.ToLocalChecked();
 
   // Create wrapper instance
-  auto binary = wasm::bin::wrapper(data->type.get());
-  auto module = Module::make(store_abs, binary);
+  auto module = store->func_wrapper(data->type.get());
+  if (!module) return own<Func>();
 
   auto imports_obj = v8::Object::New(isolate);
   auto module_obj = v8::Object::New(isolate);
@@ -1613,7 +2953,7 @@ auto make_func(Store* store_abs, FuncData* data) -> own<Func> {
   ignore(module_obj->DefineOwnProperty(context, str, func_obj));
 
   v8::Local<v8::Value> instantiate_args[] = {
-    impl(module.get())->v8_object(), imports_obj
+    impl(module)->v8_object(), imports_obj
   };
   auto instance_obj = store->v8_function(V8_F_INSTANCE)->NewInstance(
     context, 2, instantiate_args).ToLocalChecked();
@@ -1622,18 +2962,11 @@ auto make_func(Store* store_abs, FuncData* data) -> own<Func> {
   auto exports_obj = wasm_v8::instance_exports(instance_obj);
   assert(!exports_obj.IsEmpty());
   assert(exports_obj->IsObject());
-  auto wrapped_func_obj = v8::Local<v8::Function>::Cast(
-    exports_obj->Get(context, str).ToLocalChecked());
-  assert(!wrapped_func_obj.IsEmpty());
-  assert(wrapped_func_obj->IsFunction());
-
-  auto func = RefImpl<Func>::make(store, wrapped_func_obj);
-  func->set_host_info(data, &FuncData::finalize_func_data);
-  return func;
+  return make_wrapped_func(
+    store, data, exports_obj->Get(context, str).ToLocalChecked());
 }
 
 auto func_type(v8::Local<v8::Object> v8_func) -> own<FuncType> {
-  // return impl(this)->data->type->copy();
   auto param_arity = wasm_v8::func_type_param_arity(v8_func);
   auto result_arity = wasm_v8::func_type_result_arity(v8_func);
   auto params = ownvec<ValType>::make_uninitialized(param_arity);
@@ -1651,6 +2984,25 @@ auto func_type(v8::Local<v8::Object> v8_func) -> own<FuncType> {
   return FuncType::make(std::move(params), std::move(results));
 }
 
+// Returns the canonical type of a function, computing it only once per handle.
+auto func_type(const RefImpl<Func>* func) -> const FuncType* {
+  if (func->type == nullptr) {
+    v8::HandleScope handle_scope(func->isolate());
+    auto type = func_type(func->v8_object());
+    func->type = func->store()->func_type(type.get());
+  }
+  return func->type->func();
+}
+
+// Returns the call stub for a function's type, resolving it only once per
+// handle.
+auto call_stub(const RefImpl<Func>* func) -> const CallStub* {
+  if (func->stub == nullptr) {
+    func->stub = func->store()->call_stub(func_type(func));
+  }
+  return func->stub;
+}
+
 }  // namespace
 
 auto Func::make(
@@ -1672,45 +3024,123 @@ auto Func::make(
   return make_func(store, data);
 }
 
+auto Func::make(
+  Store* store, const FuncType* type,
+  callback_raw callback, void* env, void (*finalizer)(void*)
+) -> own<Func> {
+  auto data = new FuncData(store, type, FuncData::CALLBACK_RAW);
+  data->callback_raw = callback;
+  data->env = env;
+  data->finalizer = finalizer;
+  return make_func(store, data);
+}
+
+auto Func::make_batch(
+  Store* store_abs, const vec<Spec>& specs
+) -> ownvec<Func> {
+  auto store = impl(store_abs);
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+  auto context = store->context();
+  auto n = specs.size();
+
+  auto funcs = ownvec<Func>::make_uninitialized(n);
+  auto datas = std::vector<FuncData*>(n);
+  auto types = std::vector<const FuncType*>(n);
+  if (!funcs) return ownvec<Func>::invalid();
+  if (n == 0) return funcs;
+
+  // Create V8 functions, importing them by index
+  auto imports_obj = v8::Object::New(isolate);
+  auto module_obj = v8::Object::New(isolate);
+  ignore(imports_obj->DefineOwnProperty(
+    context, store->v8_string(V8_S_EMPTY), module_obj));
+  for (size_t i = 0; i < n; ++i) {
+    auto data = new FuncData(store_abs, specs[i].type, FuncData::CALLBACK_WITH_ENV);
+    data->callback_with_env = specs[i].callback;
+    data->env = specs[i].env;
+    data->finalizer = specs[i].finalizer;
+    datas[i] = data;
+    types[i] = data->type.get();
+    auto maybe_func_obj = make_host_function(store, data);
+    if (maybe_func_obj.IsEmpty()) {
+      for (size_t j = 0; j <= i; ++j) delete datas[j];
+      return ownvec<Func>::invalid();
+    }
+    ignore(module_obj->Set(context, i, maybe_func_obj.ToLocalChecked()));
+  }
+
+  // Create one wrapper instance for all of them
+  auto binary = wasm::bin::wrapper(n, types.data());
+  auto module = compile(store, binary);
+  if (!module) {
+    for (size_t i = 0; i < n; ++i) delete datas[i];
+    return ownvec<Func>::invalid();
+  }
+
+  v8::Local<v8::Value> instantiate_args[] = {
+    impl(module.get())->v8_object(), imports_obj
+  };
+  auto instance_obj = store->v8_function(V8_F_INSTANCE)->NewInstance(
+    context, 2, instantiate_args).ToLocalChecked();
+  assert(!instance_obj.IsEmpty());
+  assert(instance_obj->IsObject());
+  auto exports_obj = wasm_v8::instance_exports(instance_obj);
+  assert(!exports_obj.IsEmpty());
+  assert(exports_obj->IsObject());
+  for (size_t i = 0; i < n; ++i) {
+    funcs[i] = make_wrapped_func(
+      store, datas[i], exports_obj->Get(context, i).ToLocalChecked());
+  }
+  return funcs;
+}
+
 auto Func::type() const -> own<FuncType> {
-  // return impl(this)->data->type->copy();
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  return func_type(impl(this)->v8_object());
+  return func_type(impl(this))->copy();
 }
 
 auto Func::param_arity() const -> size_t {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  return wasm_v8::func_type_param_arity(impl(this)->v8_object());
+  return func_type(impl(this))->params().size();
 }
 
 auto Func::result_arity() const -> size_t {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  return wasm_v8::func_type_result_arity(impl(this)->v8_object());
+  return func_type(impl(this))->results().size();
 }
 
 auto Func::call(const vec<Val>& args, vec<Val>& results) const -> own<Trap> {
+#ifndef NDEBUG
+  auto type = func_type(impl(this));
+  assert(args.size() == type->params().size());
+  assert(results.size() == type->results().size());
+  for (size_t i = 0; i < args.size(); ++i) {
+    assert(args[i].kind() == type->params()[i]->kind());
+  }
+#endif
+  return call_unchecked(args.get(), results.get());
+}
+
+auto Func::call_unchecked(const Val args[], Val results[]) const -> own<Trap> {
   auto func = impl(this);
   auto store = func->store();
   auto isolate = store->isolate();
   v8::HandleScope handle_scope(isolate);
 
   auto context = store->context();
-  auto type = this->type();
-  auto& param_types = type->params();
-  auto& result_types = type->results();
-
-  // TODO: cache v8_args array per thread.
-  auto v8_args = std::unique_ptr<v8::Local<v8::Value>[]>(
-    new(std::nothrow) v8::Local<v8::Value>[param_types.size()]);
-  for (size_t i = 0; i < param_types.size(); ++i) {
-    assert(args[i].kind() == param_types[i]->kind());
-    v8_args[i] = val_to_v8(store, args[i]);
+  auto stub = call_stub(func);
+  if (!stub) {
+    auto message = Message::make(std::string("out of memory"));
+    return Trap::make(seal<Store>(store), message);
   }
+  auto num_params = stub->num_params;
+  auto num_results = stub->num_results;
+
+  auto v8_args = store->v8_args(num_params);
+  stub->convert_params(store, stub, args, v8_args);
 
   v8::TryCatch handler(isolate);
   auto v8_function = v8::Local<v8::Function>::Cast(func->v8_object());
   auto maybe_val = v8_function->Call(
-    context, v8::Undefined(isolate), param_types.size(), v8_args.get());
+    context, v8::Undefined(isolate), num_params, v8_args);
 
   if (handler.HasCaught()) {
     auto exception = handler.Exception();
@@ -1724,20 +3154,11 @@ auto Func::call(const vec<Val>& args, vec<Val>& results) const -> own<Trap> {
   }
 
   auto val = maybe_val.ToLocalChecked();
-  if (result_types.size() == 0) {
+  if (num_results == 0) {
     assert(val->IsUndefined());
-  } else if (result_types.size() == 1) {
-    assert(!val->IsUndefined());
-    new (&results[0]) Val(v8_to_val(store, val, result_types[0].get()));
   } else {
-    assert(val->IsArray());
-    auto array = v8::Handle<v8::Array>::Cast(val);
-    for (size_t i = 0; i < result_types.size(); ++i) {
-      auto maybe = array->Get(context, i);
-      assert(!maybe.IsEmpty());
-      new (&results[i]) Val(v8_to_val(
-        store, maybe.ToLocalChecked(), result_types[i].get()));
-    }
+    assert(!val->IsUndefined());
+    stub->convert_results(store, stub, val, results);
   }
   return nullptr;
 }
@@ -1751,43 +3172,75 @@ void FuncData::v8_callback(const v8::FunctionCallbackInfo<v8::Value>& info) {
 
   auto& param_types = self->type->params();
   auto& result_types = self->type->results();
+  auto num_params = param_types.size();
+  auto num_results = result_types.size();
 
-  assert(param_types.size() == info.Length());
+  assert(num_params == info.Length());
 
-  // TODO: cache params and result arrays per thread.
-  auto args = vec<Val>::make_uninitialized(param_types.size());
-  auto results = vec<Val>::make_uninitialized(result_types.size());
-  for (size_t i = 0; i < param_types.size(); ++i) {
-    args[i] = v8_to_val(store, info[i], param_types[i].get());
+  auto args = store->push_vals(num_params);
+  auto results = store->push_vals(num_results);
+  auto borrowed_mark = store->borrowed_mark();
+  for (size_t i = 0; i < num_params; ++i) {
+    if (is_ref(param_types[i]->kind())) {
+      args[i] = Val(v8_to_borrowed_ref(store, info[i]));
+    } else {
+      args[i] = v8_to_val(store, info[i], param_types[i].get());
+    }
   }
 
   own<Trap> trap;
-  if (self->kind == CALLBACK_WITH_ENV) {
-    trap = self->callback_with_env(self->env, args, results);
+  if (self->kind == CALLBACK_RAW) {
+    trap = self->callback_raw(self->env, args, results);
   } else {
-    trap = self->callback(args, results);
+    // Lend the frames to the callback as vectors.
+    auto args_vec = num_params == 0
+      ? vec<Val>::make() : vec<Val>::adopt(num_params, args);
+    auto results_vec = num_results == 0
+      ? vec<Val>::make() : vec<Val>::adopt(num_results, results);
+    if (self->kind == CALLBACK_WITH_ENV) {
+      trap = self->callback_with_env(self->env, args_vec, results_vec);
+    } else {
+      trap = self->callback(args_vec, results_vec);
+    }
+    args_vec.release();
+    if (num_results > 0 && results_vec.get() != results) {
+      // The callback replaced the results vector, freeing the frame.
+      store->drop_vals();
+      results = store->push_vals(num_results);
+      for (size_t i = 0; i < num_results; ++i) {
+        results[i] = std::move(results_vec[i]);
+      }
+    } else {
+      results_vec.release();
+    }
   }
 
   if (trap) {
+    store->pop_vals(results, num_results);
+    store->pop_vals(args, num_params);
+    store->release_borrowed(borrowed_mark);
     isolate->ThrowException(impl(trap.get())->v8_object());
     return;
   }
 
   auto ret = info.GetReturnValue();
-  if (result_types.size() == 0) {
+  if (num_results == 0) {
     ret.SetUndefined();
-  } else if (result_types.size() == 1) {
+  } else if (num_results == 1) {
     assert(results[0].kind() == result_types[0]->kind());
     ret.Set(val_to_v8(store, results[0]));
   } else {
     auto context = store->context();
-    auto array = v8::Array::New(isolate, result_types.size());
-    for (size_t i = 0; i < result_types.size(); ++i) {
+    auto array = v8::Array::New(isolate, num_results);
+    for (size_t i = 0; i < num_results; ++i) {
       auto success = array->Set(context, i, val_to_v8(store, results[i]));
       assert(success.IsJust() && success.ToChecked());
     }
     ret.Set(array);
   }
+  store->pop_vals(results, num_results);
+  store->pop_vals(args, num_params);
+  store->release_borrowed(borrowed_mark);
 }
 
 void FuncData::finalize_func_data(void* data) {
@@ -1802,10 +3255,40 @@ template<> struct implement<Global> { using type = RefImpl<Global>; };
 
 Global::~Global() {}
 
+auto StoreImpl::global_wrapper(const GlobalType* type) -> const Module* {
+  auto key = global_key(type->content()->kind(), type->mutability());
+  auto& module = global_wrappers_[key];
+  if (module) {
+    ++counters_.global_wrapper_hits;
+    return module.get();
+  }
+  ++counters_.global_wrapper_misses;
+  auto binary = wasm::bin::wrapper(type);
+  module = compile(this, binary);
+  return module.get();
+}
+
 auto Global::copy() const -> own<Global> {
   return impl(this)->copy();
 }
 
+namespace {
+
+// Returns the canonical type of a global, computing it only once per handle.
+auto global_type(const RefImpl<Global>* global) -> const GlobalType* {
+  if (global->type == nullptr) {
+    v8::HandleScope handle_scope(global->isolate());
+    auto v8_global = global->v8_object();
+    auto kind = static_cast<ValKind>(wasm_v8::global_type_content(v8_global));
+    auto mutability = wasm_v8::global_type_mutable(v8_global)
+      ? Mutability::VAR : Mutability::CONST;
+    global->type = global->store()->global_type(kind, mutability);
+  }
+  return global->type->global();
+}
+
+}  // namespace
+
 auto Global::make(
   Store* store_abs, const GlobalType* type, const Val& val
 ) -> own<Global> {
@@ -1817,10 +3300,10 @@ auto Global::make(
   assert(type->content()->kind() == val.kind());
 
   // Create wrapper instance
-  auto binary = wasm::bin::wrapper(type);
-  auto module = Module::make(store_abs, binary);
+  auto module = store->global_wrapper(type);
+  if (!module) return own<Global>();
 
-  v8::Local<v8::Value> instantiate_args[] = { impl(module.get())->v8_object() };
+  v8::Local<v8::Value> instantiate_args[] = { impl(module)->v8_object() };
   auto instance_obj = store->v8_function(V8_F_INSTANCE)->NewInstance(
     context, 1, instantiate_args).ToLocalChecked();
   auto exports_obj = wasm_v8::instance_exports(instance_obj);
@@ -1830,24 +3313,20 @@ auto Global::make(
 
   auto global = RefImpl<Global>::make(store, obj);
   assert(global);
+  impl(global.get())->type =
+    store->global_type(type->content()->kind(), type->mutability());
   global->set(val);
   return global;
 }
 
 auto Global::type() const -> own<GlobalType> {
-  // return impl(this)->data->type->copy();
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  auto v8_global = impl(this)->v8_object();
-  auto kind = static_cast<ValKind>(wasm_v8::global_type_content(v8_global));
-  auto mutability = wasm_v8::global_type_mutable(v8_global)
-    ? Mutability::VAR : Mutability::CONST;
-  return GlobalType::make(ValType::make(kind), mutability);
+  return global_type(impl(this))->copy();
 }
 
 auto Global::get() const -> Val {
   v8::HandleScope handle_scope(impl(this)->isolate());
   auto v8_global = impl(this)->v8_object();
-  switch (type()->content()->kind()) {
+  switch (global_type(impl(this))->content()->kind()) {
     case ValKind::I32: return Val(wasm_v8::global_get_i32(v8_global));
     case ValKind::I64: return Val(wasm_v8::global_get_i64(v8_global));
     case ValKind::F32: return Val(wasm_v8::global_get_f32(v8_global));
@@ -1880,6 +3359,54 @@ void Global::set(const Val& val) {
   }
 }
 
+auto Global::get_i32() const -> int32_t {
+  if (global_type(impl(this))->content()->kind() != ValKind::I32) return 0;
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  return wasm_v8::global_get_i32(impl(this)->v8_object());
+}
+
+auto Global::get_i64() const -> int64_t {
+  if (global_type(impl(this))->content()->kind() != ValKind::I64) return 0;
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  return wasm_v8::global_get_i64(impl(this)->v8_object());
+}
+
+auto Global::get_f32() const -> float32_t {
+  if (global_type(impl(this))->content()->kind() != ValKind::F32) return 0;
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  return wasm_v8::global_get_f32(impl(this)->v8_object());
+}
+
+auto Global::get_f64() const -> float64_t {
+  if (global_type(impl(this))->content()->kind() != ValKind::F64) return 0;
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  return wasm_v8::global_get_f64(impl(this)->v8_object());
+}
+
+void Global::set_i32(int32_t val) {
+  if (global_type(impl(this))->content()->kind() != ValKind::I32) return;
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  wasm_v8::global_set_i32(impl(this)->v8_object(), val);
+}
+
+void Global::set_i64(int64_t val) {
+  if (global_type(impl(this))->content()->kind() != ValKind::I64) return;
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  wasm_v8::global_set_i64(impl(this)->v8_object(), val);
+}
+
+void Global::set_f32(float32_t val) {
+  if (global_type(impl(this))->content()->kind() != ValKind::F32) return;
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  wasm_v8::global_set_f32(impl(this)->v8_object(), val);
+}
+
+void Global::set_f64(float64_t val) {
+  if (global_type(impl(this))->content()->kind() != ValKind::F64) return;
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  wasm_v8::global_set_f64(impl(this)->v8_object(), val);
+}
+
 
 // Table Instances
 
@@ -2008,6 +3535,66 @@ auto Memory::grow(pages_t delta) -> bool {
 }
 
 
+// Memory Snapshots
+
+struct MemorySnapshotImpl {
+  Memory::pages_t pages;
+  vec<byte_t> data = vec<byte_t>::make();
+
+  MemorySnapshotImpl() { stats.make(Stats::MEMORYSNAPSHOT, this); }
+  ~MemorySnapshotImpl() { stats.free(Stats::MEMORYSNAPSHOT, this); }
+};
+
+template<> struct implement<MemorySnapshot> { using type = MemorySnapshotImpl; };
+
+
+MemorySnapshot::~MemorySnapshot() {
+  impl(this)->~MemorySnapshotImpl();
+}
+
+void MemorySnapshot::operator delete(void *p) {
+  ::operator delete(p);
+}
+
+auto MemorySnapshot::size() const -> Memory::pages_t {
+  return impl(this)->pages;
+}
+
+auto Memory::snapshot() const -> own<MemorySnapshot> {
+  auto snapshot = make_own(new(std::nothrow) MemorySnapshotImpl());
+  if (!snapshot) return own<MemorySnapshot>();
+  auto data = this->data();
+  auto size = data_size();
+  snapshot->pages = this->size();
+  snapshot->data = vec<byte_t>::make_uninitialized(size);
+  if (!snapshot->data) return own<MemorySnapshot>();
+  if (size > 0) std::memcpy(snapshot->data.get(), data, size);
+  return make_own(seal<MemorySnapshot>(snapshot.release()));
+}
+
+// Every block is compared with the snapshot, and only those that differ are
+// written back, so that pages left untouched since are not dirtied again.
+// Written pages are not tracked: write-protection faults inside Wasm code
+// would be taken by V8's trap handler as out-of-bounds accesses, soft-dirty
+// bits are shared by the whole process, and V8 allocates Wasm memories
+// itself, leaving no way to back them with a copy-on-write image.
+auto Memory::restore(const MemorySnapshot* snapshot_abs) -> bool {
+  static const size_t block_size = 4096;
+  auto snapshot = impl(snapshot_abs);
+  if (size() != snapshot->pages) return false;
+  auto data = this->data();
+  auto image = snapshot->data.get();
+  auto size = data_size();
+  for (size_t offset = 0; offset < size; offset += block_size) {
+    auto n = std::min(block_size, size - offset);
+    if (std::memcmp(data + offset, image + offset, n) != 0) {
+      std::memcpy(data + offset, image + offset, n);
+    }
+  }
+  return true;
+}
+
+
 // Module Instances
 
 template<> struct implement<Instance> { using type = RefImpl<Instance>; };
@@ -2032,38 +3619,32 @@ auto Instance::make(
   assert(wasm_v8::object_isolate(module->v8_object()) == isolate);
 
   if (trap) *trap = nullptr;
-  auto import_types = module_abs->imports();
-  auto imports_obj = v8::Object::New(isolate);
-  for (size_t i = 0; i < import_types.size(); ++i) {
-    auto type = import_types[i].get();
-    auto maybe_module = v8::String::NewFromOneByte(
-      isolate, reinterpret_cast<const uint8_t*>(type->module().get()),
-      v8::NewStringType::kNormal, type->module().size()
-    );
-    if (maybe_module.IsEmpty()) return own<Instance>();
-    auto module_str = maybe_module.ToLocalChecked();
-    auto maybe_name = v8::String::NewFromOneByte(
-      isolate, reinterpret_cast<const uint8_t*>(type->name().get()),
-      v8::NewStringType::kNormal, type->name().size()
-    );
-    if (maybe_name.IsEmpty()) return own<Instance>();
-    auto name_str = maybe_name.ToLocalChecked();
+  auto module_obj = module->v8_object();
+  auto data = module_data(store, module_obj).get();
+  auto maybe_plan = import_plan(store, module_obj, data);
+  if (maybe_plan.IsEmpty()) return own<Instance>();
+  auto plan = maybe_plan.ToLocalChecked();
 
-    v8::Local<v8::Object> module_obj;
-    if (imports_obj->HasOwnProperty(context, module_str).ToChecked()) {
-      module_obj = v8::Local<v8::Object>::Cast(
-        imports_obj->Get(context, module_str).ToLocalChecked());
-    } else {
-      module_obj = v8::Object::New(isolate);
-      ignore(imports_obj->DefineOwnProperty(context, module_str, module_obj));
-    }
-
-    ignore(module_obj->DefineOwnProperty(
-      context, name_str, extern_to_v8(imports[i])));
+  auto imports_obj = v8::Object::New(isolate);
+  auto num_modules = data->import_modules.size();
+  auto module_objs = store->v8_args(num_modules);
+  for (size_t i = 0; i < num_modules; ++i) {
+    module_objs[i] = v8::Object::New(isolate);
+    ignore(imports_obj->DefineOwnProperty(context,
+      v8::Local<v8::Name>::Cast(plan->Get(context, i).ToLocalChecked()),
+      module_objs[i]));
+  }
+  for (size_t i = 0; i < data->imports.size(); ++i) {
+    auto import_module_obj = v8::Local<v8::Object>::Cast(
+      module_objs[data->import_module_indices[i]]);
+    ignore(import_module_obj->DefineOwnProperty(context,
+      v8::Local<v8::Name>::Cast(
+        plan->Get(context, num_modules + i).ToLocalChecked()),
+      extern_to_v8(imports[i])));
   }
 
   v8::TryCatch handler(isolate);
-  v8::Local<v8::Value> instantiate_args[] = {module->v8_object(), imports_obj};
+  v8::Local<v8::Value> instantiate_args[] = {module_obj, imports_obj};
   auto obj = store->v8_function(V8_F_INSTANCE)->NewInstance(
     context, 2, instantiate_args).ToLocalChecked();
 
@@ -2082,11 +3663,52 @@ auto Instance::make(
   return RefImpl<Instance>::make(store, obj);
 }
 
+namespace {
+
+auto make_export(
+  StoreImpl* store, v8::Local<v8::Object> exports_obj, const ExportType* export_type
+) -> own<Extern> {
+  auto context = store->context();
+  auto& name = export_type->name();
+  auto maybe_name_obj = v8::String::NewFromUtf8(store->isolate(), name.get(),
+    v8::NewStringType::kNormal, name.size());
+  if (maybe_name_obj.IsEmpty()) return nullptr;
+  auto name_obj = maybe_name_obj.ToLocalChecked();
+  auto obj = v8::Local<v8::Object>::Cast(
+    exports_obj->Get(context, name_obj).ToLocalChecked());
+
+  auto type = export_type->type();
+  switch (type->kind()) {
+    case ExternKind::FUNC: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_FUNC);
+      auto func = RefImpl<Func>::make(store, obj);
+      if (func) impl(func.get())->type = store->func_type(type->func());
+      return func;
+    }
+    case ExternKind::GLOBAL: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_GLOBAL);
+      auto global = RefImpl<Global>::make(store, obj);
+      if (global) impl(global.get())->type = store->global_type(
+        type->global()->content()->kind(), type->global()->mutability());
+      return global;
+    }
+    case ExternKind::TABLE: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_TABLE);
+      return RefImpl<Table>::make(store, obj);
+    }
+    case ExternKind::MEMORY: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_MEMORY);
+      return RefImpl<Memory>::make(store, obj);
+    }
+  }
+}
+
+}  // namespace
+
 auto Instance::exports() const -> ownvec<Extern> {
   auto instance = impl(this);
   auto store = instance->store();
   auto isolate = store->isolate();
-  auto context = store->context();
   v8::HandleScope handle_scope(isolate);
 
   auto module_obj = wasm_v8::instance_module(instance->v8_object());
@@ -2094,44 +3716,317 @@ auto Instance::exports() const -> ownvec<Extern> {
   assert(!module_obj.IsEmpty() && module_obj->IsObject());
   assert(!exports_obj.IsEmpty() && exports_obj->IsObject());
 
-  auto module = RefImpl<Module>::make(store, module_obj);
-  auto export_types = module->exports();
+  auto& export_types = module_data(store, module_obj)->exports;
   auto exports = ownvec<Extern>::make_uninitialized(export_types.size());
   if (!exports) return ownvec<Extern>::invalid();
 
   for (size_t i = 0; i < export_types.size(); ++i) {
-    auto& name = export_types[i]->name();
-    auto maybe_name_obj = v8::String::NewFromUtf8(isolate, name.get(),
-      v8::NewStringType::kNormal, name.size());
-    if (maybe_name_obj.IsEmpty()) return ownvec<Extern>::invalid();
-    auto name_obj = maybe_name_obj.ToLocalChecked();
-    auto obj = v8::Local<v8::Object>::Cast(
-      exports_obj->Get(context, name_obj).ToLocalChecked());
-
-    auto type = export_types[i]->type();
-    switch (type->kind()) {
-      case ExternKind::FUNC: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_FUNC);
-        exports[i] = RefImpl<Func>::make(store, obj);
+    exports[i] = make_export(store, exports_obj, export_types[i].get());
+    if (!exports[i]) return ownvec<Extern>::invalid();
+  }
+
+  return exports;
+}
+
+auto Instance::export_by_name(const Name& name) const -> own<Extern> {
+  auto instance = impl(this);
+  auto store = instance->store();
+  v8::HandleScope handle_scope(store->isolate());
+
+  auto module_obj = wasm_v8::instance_module(instance->v8_object());
+  auto& indices = module_data(store, module_obj)->export_indices;
+  auto it = indices.find(std::string(name.get(), name.size()));
+  if (it == indices.end()) return nullptr;
+  return export_by_index(it->second);
+}
+
+auto Instance::export_by_index(size_t index) const -> own<Extern> {
+  auto instance = impl(this);
+  auto store = instance->store();
+  v8::HandleScope handle_scope(store->isolate());
+
+  auto module_obj = wasm_v8::instance_module(instance->v8_object());
+  auto exports_obj = wasm_v8::instance_exports(instance->v8_object());
+  auto& export_types = module_data(store, module_obj)->exports;
+  if (index >= export_types.size()) return nullptr;
+  return make_export(store, exports_obj, export_types[index].get());
+}
+
+
+// Instance Pools
+
+struct InstancePoolImpl {
+  struct MemorySnapshot {
+    size_t index;
+    own<wasm::MemorySnapshot> snapshot;
+  };
+
+  struct GlobalSnapshot {
+    size_t index;
+    Val val;
+  };
+
+  struct TableSnapshot {
+    size_t index;
+    size_t size;
+  };
+
+  Store* store;
+  own<Module> module;
+  ownvec<Extern> imports = ownvec<Extern>::make();
+  vec<Extern*> import_ptrs = vec<Extern*>::make();
+  size_t size = 0;
+  std::vector<own<Instance>> instances;
+  // Instances are only restored if all their mutable state is exported.
+  bool recyclable = false;
+  std::vector<MemorySnapshot> memories;
+  std::vector<GlobalSnapshot> globals;
+  std::vector<size_t> ref_globals;
+  std::vector<TableSnapshot> tables;
+  InstancePool::Metrics metrics = {};
+
+  InstancePoolImpl() { stats.make(Stats::INSTANCEPOOL, this); }
+  ~InstancePoolImpl() { stats.free(Stats::INSTANCEPOOL, this); }
+
+  auto instantiate(own<Trap>* trap = nullptr) -> own<Instance>;
+  auto snapshot(const Instance* instance) -> bool;
+  auto save_refs(const Instance* instance) -> bool;
+  auto restore(const Instance* instance) -> bool;
+};
+
+template<> struct implement<InstancePool> { using type = InstancePoolImpl; };
+
+
+auto InstancePoolImpl::instantiate(own<Trap>* trap) -> own<Instance> {
+  auto start = std::chrono::steady_clock::now();
+  auto instance = Instance::make(store, module.get(), import_ptrs, trap);
+  if (instance && recyclable && !save_refs(instance.get())) instance.reset();
+  metrics.instantiate_ns += elapsed_ns(start);
+  return instance;
+}
+
+// Records the exported state shared by all pristine instances. References
+// differ between instances, so only their locations are recorded here.
+auto InstancePoolImpl::snapshot(const Instance* instance) -> bool {
+  auto exports = instance->exports();
+  if (!exports) return false;
+  for (size_t i = 0; i < exports.size(); ++i) {
+    // State shared with the host through imports is not ours to restore.
+    bool imported = false;
+    for (size_t j = 0; j < imports.size(); ++j) {
+      if (exports[i]->same(imports[j].get())) imported = true;
+    }
+    if (imported) continue;
+
+    switch (exports[i]->kind()) {
+      case ExternKind::MEMORY: {
+        auto snapshot = exports[i]->memory()->snapshot();
+        if (!snapshot) return false;
+        memories.push_back({i, std::move(snapshot)});
       } break;
       case ExternKind::GLOBAL: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_GLOBAL);
-        exports[i] = RefImpl<Global>::make(store, obj);
+        auto global = exports[i]->global();
+        auto type = global_type(impl(global));
+        if (type->mutability() == Mutability::VAR) {
+          if (type->content()->is_ref()) {
+            ref_globals.push_back(i);
+          } else {
+            globals.push_back({i, global->get()});
+          }
+        }
       } break;
       case ExternKind::TABLE: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_TABLE);
-        exports[i] = RefImpl<Table>::make(store, obj);
-      } break;
-      case ExternKind::MEMORY: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_MEMORY);
-        exports[i] = RefImpl<Memory>::make(store, obj);
+        tables.push_back({i, exports[i]->table()->size()});
       } break;
+      case ExternKind::FUNC: break;
     }
   }
+  return true;
+}
 
-  return exports;
+// Saves a pristine instance's table elements and reference globals on the
+// instance itself, so that it is restored to its own functions.
+auto InstancePoolImpl::save_refs(const Instance* instance) -> bool {
+  auto store_impl = impl(store);
+  auto isolate = store_impl->isolate();
+  auto context = store_impl->context();
+  v8::HandleScope handle_scope(isolate);
+
+  auto length = ref_globals.size();
+  for (auto& snapshot : tables) length += snapshot.size;
+  auto refs = v8::Array::New(isolate, static_cast<int>(length));
+  uint32_t k = 0;
+  for (auto& snapshot : tables) {
+    auto ex = instance->export_by_index(snapshot.index);
+    if (!ex) return false;
+    auto table = impl(ex->table())->v8_object();
+    for (size_t j = 0; j < snapshot.size; ++j) {
+      auto maybe = wasm_v8::table_get(table, j);
+      if (maybe.IsEmpty()) return false;
+      if (!refs->Set(context, k++, maybe.ToLocalChecked()).FromMaybe(false)) {
+        return false;
+      }
+    }
+  }
+  for (auto index : ref_globals) {
+    auto ex = instance->export_by_index(index);
+    if (!ex) return false;
+    auto global = impl(ex->global())->v8_object();
+    auto ref = wasm_v8::global_get_ref(global);
+    if (!refs->Set(context, k++, ref).FromMaybe(false)) return false;
+  }
+  auto key = store_impl->v8_private(V8_P_POOL_REFS);
+  return impl(instance)->v8_object()->SetPrivate(context, key, refs)
+    .FromMaybe(false);
+}
+
+auto InstancePoolImpl::restore(const Instance* instance) -> bool {
+  // Memories and tables cannot shrink, so grown ones are not restorable.
+  for (auto& snapshot : memories) {
+    auto ex = instance->export_by_index(snapshot.index);
+    if (!ex || ex->memory()->size() != snapshot.snapshot->size()) return false;
+  }
+  for (auto& snapshot : tables) {
+    auto ex = instance->export_by_index(snapshot.index);
+    if (!ex || ex->table()->size() != snapshot.size) return false;
+  }
+
+  auto store_impl = impl(store);
+  auto context = store_impl->context();
+  v8::HandleScope handle_scope(store_impl->isolate());
+  auto key = store_impl->v8_private(V8_P_POOL_REFS);
+  auto maybe = impl(instance)->v8_object()->GetPrivate(context, key);
+  if (maybe.IsEmpty() || !maybe.ToLocalChecked()->IsArray()) return false;
+  auto refs = v8::Local<v8::Array>::Cast(maybe.ToLocalChecked());
+
+  for (auto& snapshot : memories) {
+    auto memory = instance->export_by_index(snapshot.index);
+    if (!memory->memory()->restore(snapshot.snapshot.get())) return false;
+  }
+  for (auto& snapshot : globals) {
+    auto global = instance->export_by_index(snapshot.index);
+    global->global()->set(snapshot.val);
+  }
+  uint32_t k = 0;
+  for (auto& snapshot : tables) {
+    auto ex = instance->export_by_index(snapshot.index);
+    auto table = impl(ex->table())->v8_object();
+    for (size_t j = 0; j < snapshot.size; ++j) {
+      auto elem = refs->Get(context, k++);
+      if (elem.IsEmpty()) return false;
+      if (!wasm_v8::table_set(table, j, elem.ToLocalChecked())) return false;
+    }
+  }
+  for (auto index : ref_globals) {
+    auto ex = instance->export_by_index(index);
+    auto ref = refs->Get(context, k++);
+    if (ref.IsEmpty()) return false;
+    wasm_v8::global_set_ref(
+      impl(ex->global())->v8_object(), ref.ToLocalChecked());
+  }
+  return true;
+}
+
+
+InstancePool::~InstancePool() {
+  impl(this)->~InstancePoolImpl();
+}
+
+void InstancePool::operator delete(void *p) {
+  ::operator delete(p);
 }
 
+auto InstancePool::make(
+  Store* store, const Module* module, const vec<Extern*>& imports,
+  size_t size, own<Trap>* trap
+) -> own<InstancePool> {
+  auto pool = make_own(new(std::nothrow) InstancePoolImpl());
+  if (!pool) return own<InstancePool>();
+
+  pool->store = store;
+  pool->module = module->copy();
+  pool->size = size;
+  pool->imports = ownvec<Extern>::make_uninitialized(imports.size());
+  pool->import_ptrs = vec<Extern*>::make_uninitialized(imports.size());
+  if (!pool->imports || !pool->import_ptrs) return own<InstancePool>();
+  for (size_t i = 0; i < imports.size(); ++i) {
+    pool->imports[i] = imports[i]->copy();
+    pool->import_ptrs[i] = pool->imports[i].get();
+  }
+
+  // The first instance defines the state that released ones are reset to.
+  auto instance = pool->instantiate(trap);
+  if (!instance) return own<InstancePool>();
+  {
+    auto store_impl = impl(store);
+    v8::HandleScope handle_scope(store_impl->isolate());
+    auto module_obj = impl(module)->v8_object();
+    // Instances can only be reset if all their mutable state is visible.
+    auto binary = vec<byte_t>::adopt(
+      wasm_v8::module_binary_size(module_obj),
+      const_cast<byte_t*>(wasm_v8::module_binary(module_obj))
+    );
+    pool->recyclable = !wasm::bin::hidden_state(binary);
+    binary.release();
+  }
+  if (pool->recyclable) {
+    if (!pool->snapshot(instance.get()) || !pool->save_refs(instance.get())) {
+      return own<InstancePool>();
+    }
+  }
+  pool->instances.reserve(size);
+  if (size > 0) pool->instances.push_back(std::move(instance));
+  while (pool->instances.size() < size) {
+    auto instance = pool->instantiate(trap);
+    if (!instance) return own<InstancePool>();
+    pool->instances.push_back(std::move(instance));
+  }
+
+  return make_own(seal<InstancePool>(pool.release()));
+}
+
+auto InstancePool::acquire() -> own<Instance> {
+  auto pool = impl(this);
+  if (pool->instances.empty()) {
+    ++pool->metrics.misses;
+    return pool->instantiate();
+  }
+  ++pool->metrics.hits;
+  auto instance = std::move(pool->instances.back());
+  pool->instances.pop_back();
+  return instance;
+}
+
+void InstancePool::release(own<Instance> instance) {
+  auto pool = impl(this);
+  if (!instance) return;
+  if (pool->instances.size() >= pool->size) {
+    ++pool->metrics.discards;
+    return;
+  }
+  if (!pool->recyclable) {
+    // State that cannot be restored must not carry over to the next user.
+    ++pool->metrics.discards;
+    instance = pool->instantiate();
+    if (instance) pool->instances.push_back(std::move(instance));
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  auto restored = pool->restore(instance.get());
+  pool->metrics.reset_ns += elapsed_ns(start);
+  if (!restored) {
+    ++pool->metrics.discards;
+    return;
+  }
+  ++pool->metrics.resets;
+  pool->instances.push_back(std::move(instance));
+}
+
+auto InstancePool::metrics() const -> const Metrics& {
+  return impl(this)->metrics;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 
 }  // namespace wasm